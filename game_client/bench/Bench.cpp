@@ -0,0 +1,529 @@
+#include "../include/AllocationCounter.h"
+#include "../include/AssetLoader.h"
+#include "../include/Autopilot.h"
+#include "../include/CollisionGrid.h"
+#include "../include/Game.h"
+#include "../include/ParticleSystem.h"
+#include "../include/Renderer.h"
+#include "../include/Simulation.h"
+#include "../include/SimSnapshot.h"
+#include "../include/SimulationThread.h"
+#include "../include/StateSnapshot.h"
+#include "../include/TerminalRenderer.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Benchmark suite for the game's hot paths, from the collision pass up to
+// whole frames. Rendering runs on SDL's offscreen video driver with the
+// software renderer, so it needs no display.
+//
+//     star_defender_bench [--filter TEXT] [--json out.json]
+//                         [--baseline base.json [--threshold PERCENT]]
+//                         [--min-time SECONDS] [--no-render]
+//
+// With --baseline the run is compared against a previous --json file and the
+// exit code is 1 if any benchmark slowed down by more than the threshold. The
+// exit code is also 1 if a steady-state simulation tick or gameplay frame,
+// stepped or drawn from the simulation thread, allocated on the heap.
+
+namespace {
+
+struct Result {
+    std::string name;
+    double nsPerOp;
+    long iterations;
+};
+
+struct Options {
+    std::string filter;
+    std::string jsonPath;
+    std::string baselinePath;
+    double threshold = 10.0;    // Percent slowdown that counts as a regression
+    double minSeconds = 0.25;   // Minimum measuring time per benchmark
+    bool render = true;
+};
+
+const int SAMPLES = 5;
+
+class Suite {
+public:
+    explicit Suite(const Options& options) : options(options) {}
+
+    bool selected(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    // Calls body, which performs opsPerCall operations, in batches sized to
+    // fill a fifth of the minimum time, and records the median batch
+    template <typename F>
+    void run(const std::string& name, long opsPerCall, F body) {
+        if (!selected(name)) return;
+        using Clock = std::chrono::steady_clock;
+
+        body(); // Warm caches and lazily built state
+        long calls = 1;
+        while (true) {
+            auto start = Clock::now();
+            for (long i = 0; i < calls; i++) body();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (seconds >= options.minSeconds / SAMPLES || calls >= (1L << 30)) break;
+            calls *= 2;
+        }
+
+        std::vector<double> samples;
+        for (int s = 0; s < SAMPLES; s++) {
+            auto start = Clock::now();
+            for (long i = 0; i < calls; i++) body();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            samples.push_back(ns / (calls * opsPerCall));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result = {name, samples[SAMPLES / 2], calls * opsPerCall * SAMPLES};
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(1) << result.nsPerOp << " ns/op" << std::endl;
+        results.push_back(result);
+    }
+
+    // Calls body, already warmed up by run(), calls more times and counts
+    // the heap allocations made; any at all is a failure
+    template <typename F>
+    void expectNoAllocations(const std::string& name, long calls, F body) {
+        if (!selected(name)) return;
+        uint64_t before = allocations::count();
+        for (long i = 0; i < calls; i++) body();
+        uint64_t allocated = allocations::count() - before;
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(14) << allocated
+                  << " allocations in " << calls << " calls" << std::endl;
+        if (allocated > 0) allocationFailures++;
+    }
+
+    const std::vector<Result>& getResults() const { return results; }
+    int getAllocationFailures() const { return allocationFailures; }
+
+private:
+    const Options& options;
+    std::vector<Result> results;
+    int allocationFailures = 0;
+};
+
+void benchCollision(Suite& suite) {
+    const int columns = 256;
+    const int rows = 256;
+    CollisionGrid grid(columns, rows);
+    std::vector<Hit> hits;
+
+    for (int count : {100, 1000, 10000}) {
+        EntityStore enemies;
+        EntityStore bullets;
+        srand(1);
+        for (int i = 0; i < count; i++) {
+            enemies.spawn(rand() % columns, rand() % rows);
+            bullets.spawn(rand() % columns, rand() % rows);
+        }
+        std::string suffix = "/" + std::to_string(count);
+        suite.run("collision/bitboard" + suffix, 1, [&] { grid.findHits(bullets, enemies, hits); });
+        if (count <= 1000) {
+            suite.run("collision/nested_loop" + suffix, 1, [&] { findHitsNestedLoop(bullets, enemies, hits); });
+        }
+    }
+}
+
+void benchSimulation(Suite& suite) {
+    // One full tick under the autopilot, restarting whenever a game ends
+    Simulation sim(800, 600, 1);
+    sim.applyAction(Simulation::Action::CONFIRM);
+    auto tick = [&] {
+        if (sim.getGameState() == Simulation::GAME_OVER) {
+            sim.applyAction(Simulation::Action::CONFIRM);
+            sim.applyAction(Simulation::Action::CONFIRM);
+        }
+        driveAutopilot(sim);
+        sim.update();
+    };
+    suite.run("simulation/update", 1, tick);
+    suite.expectNoAllocations("simulation/update", 10000, tick);
+}
+
+void benchParticles(Suite& suite) {
+    for (int count : {1000, 10000, 100000}) {
+        ParticleSystem particles(count);
+        srand(1);
+        for (int i = 0; i < count; i++) {
+            // Effectively immortal, so every update touches the full count
+            particles.emit(rand() % 800, rand() % 600, (rand() % 200 - 100) / 100.0f,
+                           (rand() % 200 - 100) / 100.0f, ParticleSystem::packColor(255, 128, 0), 1 << 30);
+        }
+        suite.run("particles/update/" + std::to_string(count), 1, [&] { particles.update(); });
+    }
+}
+
+// Encode, delta and restore costs for one tick's change, on a regular game
+// and on a crowded grid. Sizes are printed alongside.
+void benchSnapshots(Suite& suite) {
+    if (!suite.selected("snapshot/")) return;
+
+    struct World {
+        std::string name;
+        int width;
+        int height;
+        int entities;
+    };
+    for (const World& world : {World{"game", 800, 600, 0}, World{"crowded", 1024 * 48, 256 * 48, 20000}}) {
+        Simulation sim(world.width, world.height, 1);
+        sim.applyAction(Simulation::Action::CONFIRM);
+        Xoshiro256 rng(1);
+        for (int i = 0; i < world.entities; i++) {
+            sim.spawnEnemy(rng.nextInt(0, sim.getColumns() - 1), rng.nextInt(0, sim.getRows() / 2 - 1));
+            sim.spawnBullet(rng.nextInt(0, sim.getColumns() - 1), rng.nextInt(sim.getRows() / 2, sim.getRows() - 2));
+        }
+        // Into the game far enough for enemies, bullets and hits
+        for (int i = 0; i < 100 && sim.getGameState() == Simulation::PLAYING; i++) {
+            driveAutopilot(sim);
+            sim.update();
+        }
+
+        std::vector<uint8_t> base, target, delta, rebuilt;
+        encodeSnapshot(sim, base);
+        driveAutopilot(sim);
+        sim.update();
+        encodeSnapshot(sim, target);
+        SnapshotView baseView, targetView;
+        baseView.open(base.data(), base.size());
+        targetView.open(target.data(), target.size());
+        encodeDelta(baseView, targetView, delta);
+        if (!applyDelta(baseView, delta.data(), delta.size(), rebuilt) || rebuilt != target) {
+            std::cerr << "Snapshot delta does not round-trip, skipping snapshot/" << world.name << std::endl;
+            continue;
+        }
+        std::cout << "snapshot/" << world.name << ": " << targetView.count(snapshot::ENEMIES) << " enemies, "
+                  << targetView.count(snapshot::BULLETS) << " bullets, full " << target.size() << " bytes, delta "
+                  << delta.size() << " bytes" << std::endl;
+
+        std::string prefix = "snapshot/" + world.name + "/";
+        Simulation restored(world.width, world.height, 1);
+        suite.run(prefix + "encode", 1, [&] { encodeSnapshot(sim, rebuilt); });
+        suite.run(prefix + "restore", 1, [&] { restored.restore(targetView); });
+        suite.run(prefix + "delta_encode", 1, [&] { encodeDelta(baseView, targetView, delta); });
+        suite.run(prefix + "delta_apply", 1, [&] { applyDelta(baseView, delta.data(), delta.size(), rebuilt); });
+    }
+}
+
+// Terminal output on the game's grid and on larger ones, each kept busy with
+// enemies and bullets in proportion to its width. Prints bytes per frame,
+// which should follow how much changes rather than the size of the grid, and
+// times composing and diffing a frame with output discarded.
+void benchTerminal(Suite& suite) {
+    if (!suite.selected("terminal/")) return;
+
+    for (auto [columns, rows] : {std::pair{16, 12}, std::pair{64, 48}, std::pair{256, 64}}) {
+        Simulation sim(columns * Simulation::TILE_SIZE, rows * Simulation::TILE_SIZE, 1);
+        sim.setEndless(true);
+        sim.applyAction(Simulation::Action::CONFIRM);
+        Xoshiro256 rng(1);
+        SimSnapshot snapshots[2];
+        TerminalRenderer renderer(columns, rows, -1);
+
+        const int frames = 600;
+        for (int frame = 0; frame < frames; frame++) {
+            for (int i = 0; i < columns / 16; i++) {
+                sim.spawnEnemy(rng.nextInt(0, columns - 1), 0);
+                sim.spawnBullet(rng.nextInt(0, columns - 1), rows - 2);
+            }
+            driveAutopilot(sim);
+            sim.update();
+            snapshots[frame % 2].capture(sim);
+            renderer.drawFrame(snapshots[frame % 2], 1.0f);
+        }
+        const TerminalRenderer::Stats& stats = renderer.stats();
+        TerminalRenderer redraw(columns, rows, -1);
+        redraw.drawFrame(snapshots[(frames - 1) % 2], 1.0f);
+        std::string name = "terminal/" + std::to_string(columns) + "x" + std::to_string(rows);
+        std::cout << name << ": " << sim.getEnemies().size() << " enemies, " << sim.getBullets().size()
+                  << " bullets, " << (stats.bytes - stats.firstFrameBytes) / (frames - 1) << " bytes per frame (max "
+                  << stats.maxFrameBytes << ") against " << redraw.stats().firstFrameBytes << " for a full redraw, "
+                  << stats.cellsChanged / frames << " cells changed per frame" << std::endl;
+
+        // Alternating between the last two ticks keeps the diff the same size
+        int frame = 0;
+        suite.run(name + "/frame", 1, [&] { renderer.drawFrame(snapshots[frame++ % 2], 1.0f); });
+    }
+}
+
+// Loads one font through the regular asset path and waits for it
+bool loadBenchFont(Renderer& renderer, const std::string& basePath) {
+    AssetLoader loader(&renderer);
+    loader.start(basePath, {{"bench", "Pixel Game.otf", 16}}, {});
+    while (!loader.areFontsReady()) {
+        loader.poll();
+        SDL_Delay(1);
+    }
+    return renderer.hasFont("bench");
+}
+
+void benchRenderer(Suite& suite, const std::string& basePath) {
+    const int width = 800;
+    const int height = 600;
+    SDL_Window* window = SDL_CreateWindow("star_defender_bench", width, height, 0);
+    if (!window) {
+        std::cerr << "Error creating window: " << SDL_GetError() << std::endl;
+        return;
+    }
+
+    {
+        Renderer renderer(window, width, height);
+
+        // Opaque 32x32 sprite, independent of the game's assets
+        std::vector<uint32_t> pixels(32 * 32, 0xffffffffu);
+        Renderer::TextureHandle sprite = renderer.loadTextureFromPixels("bench_sprite", pixels.data(), 32, 32);
+
+        // Submission alone: the batch is dropped by clear() rather than drawn
+        const int sprites = 10000;
+        suite.run("render/drawTexture_submit", sprites, [&] {
+            for (int i = 0; i < sprites; i++) {
+                renderer.drawTexture(sprite, (i * 37) % width, (i * 91) % height, 32, 32);
+            }
+            renderer.clear();
+        });
+        suite.run("render/drawTexture_present", 1000, [&] {
+            renderer.clear();
+            for (int i = 0; i < 1000; i++) {
+                renderer.drawTexture(sprite, (i * 37) % width, (i * 91) % height, 32, 32);
+            }
+            renderer.present();
+        });
+
+        if (loadBenchFont(renderer, basePath)) {
+            const int strings = 100;
+            suite.run("render/drawText", strings, [&] {
+                for (int i = 0; i < strings; i++) {
+                    renderer.drawText("bench", "Score: 123456", 20, (i * 6) % height, 255, 255, 255);
+                }
+                renderer.clear();
+            });
+            suite.run("render/drawTextCentered", strings, [&] {
+                for (int i = 0; i < strings; i++) {
+                    renderer.drawTextCentered("bench", "Press SPACE or ENTER to Start", (i * 6) % height, 255, 255, 255);
+                }
+                renderer.clear();
+            });
+        } else {
+            std::cerr << "Font unavailable, skipping text benchmarks" << std::endl;
+        }
+    }
+    SDL_DestroyWindow(window);
+}
+
+void benchFrames(Suite& suite) {
+    if (!suite.selected("frame/")) return;
+    const int width = 800;
+    const int height = 600;
+    SDL_Window* window = SDL_CreateWindow("star_defender_bench", width, height, 0);
+    if (!window) {
+        std::cerr << "Error creating window: " << SDL_GetError() << std::endl;
+        return;
+    }
+
+    {
+        Game game(window, width, height, 1);
+        while (!game.assetsReady()) {
+            game.step(0, 0.0f);
+        }
+        Simulation& sim = game.getSimulation();
+
+        suite.run("frame/menu", 1, [&] { game.step(0, 0.0f); });
+
+        // Rendering at 60 Hz draws five frames per 12 Hz tick
+        sim.applyAction(Simulation::Action::CONFIRM);
+        int frame = 0;
+        auto gameplayFrame = [&] {
+            if (sim.getGameState() == Simulation::GAME_OVER) {
+                sim.applyAction(Simulation::Action::CONFIRM);
+                sim.applyAction(Simulation::Action::CONFIRM);
+            }
+            driveAutopilot(sim);
+            game.step(frame % 5 == 0 ? 1 : 0, (frame % 5) / 5.0f);
+            frame++;
+        };
+        suite.run("frame/gameplay", 1, gameplayFrame);
+        suite.expectNoAllocations("frame/gameplay", 1000, gameplayFrame);
+
+        // Static layers should redraw only when what they show changes
+        for (const Renderer::LayerStats& layer : game.getRenderer().getLayerStats()) {
+            std::cout << "  layer " << layer.name << ": " << layer.rebuilds << " rebuilds, " << layer.composites
+                      << " composites" << std::endl;
+        }
+
+        // The path run() takes: the simulation ticks on its own thread while
+        // this one pushes input and draws the latest snapshot. Each call
+        // covers one tick, so the thread's capture and publish are counted.
+        if (suite.selected("frame/threaded")) {
+            Simulation threadedSim(width, height, 1);
+            InputRecorder recorder;
+            SimulationThread simThread(threadedSim, recorder);
+            simThread.start();
+            simThread.pushAction(Simulation::Action::CONFIRM);
+            auto threadedTick = [&] {
+                const SimSnapshot& current = simThread.latest();
+                int tick = current.tick;
+                if (current.state == Simulation::GAME_OVER) {
+                    simThread.pushAction(Simulation::Action::CONFIRM);
+                    simThread.pushAction(Simulation::Action::CONFIRM);
+                } else {
+                    // Steer under the lowest enemy and keep firing
+                    int target = current.playerX, lowest = -1;
+                    for (size_t i = 0; i < current.enemies.size(); i++) {
+                        if (current.enemies.y[i] > lowest) {
+                            lowest = current.enemies.y[i];
+                            target = current.enemies.x[i];
+                        }
+                    }
+                    if (target != current.playerX) {
+                        simThread.pushAction(target < current.playerX ? Simulation::Action::MOVE_LEFT
+                                                                      : Simulation::Action::MOVE_RIGHT);
+                    }
+                    simThread.pushAction(Simulation::Action::FIRE);
+                }
+                int frames = 0;
+                for (;;) {
+                    const SimSnapshot& snapshot = simThread.latest();
+                    game.drawFrame(snapshot, (frames % 5) / 5.0f);
+                    frames++;
+                    if (snapshot.tick != tick) break;
+                }
+            };
+            for (int i = 0; i < Simulation::TICKS_PER_SECOND; i++) threadedTick();
+            suite.expectNoAllocations("frame/threaded", 3 * Simulation::TICKS_PER_SECOND, threadedTick);
+            simThread.stop();
+        }
+    }
+    SDL_DestroyWindow(window);
+}
+
+bool writeJson(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error writing " << path << std::endl;
+        return false;
+    }
+    out << std::setprecision(6) << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "    {\"name\": \"" << results[i].name << "\", \"ns_per_op\": " << results[i].nsPerOp
+            << ", \"iterations\": " << results[i].iterations << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// Reads back the name/ns_per_op pairs of a file written by writeJson
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Error reading baseline " << path << std::endl;
+        return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    std::string text = contents.str();
+
+    std::regex entry("\"name\"\\s*:\\s*\"([^\"]+)\"\\s*,\\s*\"ns_per_op\"\\s*:\\s*([-+0-9.eE]+)");
+    for (std::sregex_iterator it(text.begin(), text.end(), entry), end; it != end; ++it) {
+        baseline[(*it)[1].str()] = std::atof((*it)[2].str().c_str());
+    }
+    return true;
+}
+
+// Prints the change against the baseline; returns the number of regressions
+int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double threshold) {
+    int regressions = 0;
+    std::cout << std::endl << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14)
+              << "baseline" << std::setw(14) << "current" << std::setw(10) << "change" << std::endl;
+    for (const Result& result : results) {
+        auto it = baseline.find(result.name);
+        std::cout << std::left << std::setw(40) << result.name << std::right << std::fixed << std::setprecision(1);
+        if (it == baseline.end() || it->second <= 0) {
+            std::cout << std::setw(14) << "-" << std::setw(14) << result.nsPerOp << std::setw(10) << "new" << std::endl;
+            continue;
+        }
+        double change = (result.nsPerOp / it->second - 1.0) * 100.0;
+        std::cout << std::setw(14) << it->second << std::setw(14) << result.nsPerOp << std::setw(9)
+                  << std::showpos << change << std::noshowpos << "%";
+        if (change > threshold) {
+            std::cout << "  REGRESSION";
+            regressions++;
+        }
+        std::cout << std::endl;
+    }
+    return regressions;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            options.baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            options.threshold = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-render") == 0) {
+            options.render = false;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--filter TEXT] [--json out.json]"
+                      << " [--baseline base.json [--threshold PERCENT]] [--min-time SECONDS] [--no-render]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!options.baselinePath.empty() && !readBaseline(options.baselinePath, baseline)) {
+        return 1;
+    }
+
+    Suite suite(options);
+    benchCollision(suite);
+    benchSimulation(suite);
+    benchParticles(suite);
+    benchSnapshots(suite);
+    benchTerminal(suite);
+
+    if (options.render) {
+        // Offscreen video with the software renderer, uncapped by vsync
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+        if (SDL_Init(SDL_INIT_VIDEO)) {
+            const char* base = SDL_GetBasePath();
+            benchRenderer(suite, base ? base : "");
+            benchFrames(suite);
+            SDL_Quit();
+        } else {
+            std::cerr << "Error initializing offscreen video, skipping render benchmarks: " << SDL_GetError() << std::endl;
+        }
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, suite.getResults())) {
+        return 1;
+    }
+    if (!options.baselinePath.empty() && compare(suite.getResults(), baseline, options.threshold) > 0) {
+        return 1;
+    }
+    return suite.getAllocationFailures() > 0 ? 1 : 0;
+}
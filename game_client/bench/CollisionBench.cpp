@@ -0,0 +1,49 @@
+#include "../include/CollisionGrid.h"
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+// Compares the nested-loop collision pass with the bitboard engine for
+// growing entity counts on a fixed grid.
+int main(int argc, char *argv[]) {
+    int columns = 256;
+    int rows = 256;
+    if (argc == 3) {
+        columns = std::atoi(argv[1]);
+        rows = std::atoi(argv[2]);
+    }
+
+    CollisionGrid grid(columns, rows);
+    std::vector<Hit> hits;
+    srand(1);
+
+    std::cout << "Grid " << columns << "x" << rows << std::endl;
+    std::cout << "entities\tnested_us\tbitboard_us\thits" << std::endl;
+
+    for (int count : {10, 100, 1000, 10000, 50000}) {
+        EntityStore enemies;
+        EntityStore bullets;
+        for (int i = 0; i < count; i++) {
+            enemies.spawn(rand() % columns, rand() % rows);
+            bullets.spawn(rand() % columns, rand() % rows);
+        }
+
+        // The nested loop is quadratic, so repeat small cases more often
+        int iterations = std::clamp(100000000 / (count * count), 1, 10000);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) findHitsNestedLoop(bullets, enemies, hits);
+        auto mid = std::chrono::steady_clock::now();
+        size_t nestedHits = hits.size();
+        for (int i = 0; i < iterations; i++) grid.findHits(bullets, enemies, hits);
+        auto end = std::chrono::steady_clock::now();
+
+        double nested = std::chrono::duration<double, std::micro>(mid - start).count() / iterations;
+        double bitboard = std::chrono::duration<double, std::micro>(end - mid).count() / iterations;
+        std::cout << count << "\t\t" << nested << "\t\t" << bitboard << "\t\t" << hits.size();
+        if (hits.size() != nestedHits) std::cout << "\tMISMATCH (" << nestedHits << ")";
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "../include/Autopilot.h"
+#include "../include/NetSession.h"
+#include "../include/SimulationThread.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// LAN co-op over loopback. A host runs the game on a SimulationThread with
+// the network hooks, as the windowed game does, and three clients join and
+// play with the autopilot: once over a clean link, then with loss, delay and
+// jitter applied by both ends. Reports bytes per client per tick, round
+// trips and the time from an action to the first frame that includes it,
+// and fails if any frame a client decoded differs from the host's by a
+// single byte.
+//
+//     star_defender_net_bench [seconds per scenario]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int CLIENTS = 3;
+
+struct Scenario {
+    const char* name;
+    LinkConditions conditions;
+};
+
+uint64_t hashBytes(const std::vector<uint8_t>& bytes) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool runScenario(const Scenario& scenario, double seconds) {
+    Simulation sim(800, 600, 1);
+    InputRecorder recorder;
+    SimulationThread simThread(sim, recorder);
+    NetHost host;
+    host.setConditions(scenario.conditions, 1);
+    if (!host.open(0)) return false;
+
+    // Every frame the host encodes, hashed on the simulation thread
+    std::unordered_map<uint32_t, uint64_t> hostFrames;
+    simThread.setNetworkHandlers([&host](Simulation& s) { return host.poll(s); },
+                                 [&](const Simulation& s) {
+                                     host.afterUpdate(s);
+                                     hostFrames[host.getFrame()] = hashBytes(*host.stateAt(host.getFrame()));
+                                 },
+                                 std::chrono::milliseconds(2));
+    simThread.start();
+    simThread.pushAction(Simulation::Action::CONFIRM);
+
+    NetAddress address;
+    address.resolve("127.0.0.1", host.getPort());
+    std::vector<std::unique_ptr<NetClient>> clients;
+    std::vector<std::unordered_map<uint32_t, uint64_t>> clientFrames(CLIENTS);
+    for (int i = 0; i < CLIENTS; i++) {
+        clients.push_back(std::make_unique<NetClient>(800, 600));
+        clients[i]->setConditions(scenario.conditions, 2 + i);
+        if (!clients[i]->connect(address, 5000)) {
+            simThread.stop();
+            return false;
+        }
+    }
+
+    auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    while (Clock::now() < end) {
+        for (int i = 0; i < CLIENTS; i++) {
+            NetClient& client = *clients[i];
+            if (!client.poll()) continue;
+            // The newest frame of the poll; several may have arrived together
+            clientFrames[i][client.getFrame()] = hashBytes(*client.stateAt(client.getFrame()));
+
+            // One decision per frame, as a player reacting to what they see
+            const Simulation& view = client.getSimulation();
+            if (view.getGameState() != Simulation::PLAYING) {
+                client.sendAction(Simulation::Action::CONFIRM);
+                continue;
+            }
+            Simulation::Action actions[2];
+            int count = chooseAutopilotActions(view, client.getPlayer(), actions);
+            for (int a = 0; a < count; a++) client.sendAction(actions[a]);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (auto& client : clients) client->disconnect();
+    simThread.stop();
+
+    NetHost::Stats hostStats = host.stats();
+    uint64_t frames = 0, skipped = 0, dropped = 0, corrections = 0, verified = 0, mismatched = 0;
+    LatencyHistogram roundTrips, latencies;
+    for (int i = 0; i < CLIENTS; i++) {
+        const NetClient::Stats& stats = clients[i]->stats();
+        frames += stats.frames;
+        skipped += stats.framesSkipped;
+        dropped += stats.framesDropped;
+        corrections += stats.corrections;
+        roundTrips.merge(stats.roundTripMs);
+        latencies.merge(stats.inputLatencyMs);
+        for (const auto& [frame, hash] : clientFrames[i]) {
+            auto expected = hostFrames.find(frame);
+            if (expected == hostFrames.end() || expected->second != hash) {
+                mismatched++;
+            } else {
+                verified++;
+            }
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << scenario.name << ": loss " << scenario.conditions.lossPercent << "%, delay "
+              << scenario.conditions.delayMs << " +/- " << scenario.conditions.jitterMs << " ms each way" << std::endl;
+    std::cout << "  host: " << hostStats.frames << " ticks, " << hostStats.framesSent << " frames sent ("
+              << hostStats.fullFrames << " full, " << hostStats.throttledFrames << " throttled), "
+              << (hostStats.framesSent ? double(hostStats.bytesSent) / hostStats.framesSent : 0.0)
+              << " bytes per client per tick" << std::endl;
+    std::cout << "  clients: " << frames << " frames applied, " << skipped << " skipped (" << dropped
+              << " partly received), " << corrections << " prediction corrections" << std::endl;
+    std::cout << "  round trip p50 " << roundTrips.percentile(0.5) << " ms, p99 " << roundTrips.percentile(0.99)
+              << " ms; action to confirmed p50 " << latencies.percentile(0.5) << " ms, p99 "
+              << latencies.percentile(0.99) << " ms" << std::endl;
+    std::cout << "  " << verified << " frames byte-identical to the host's, " << mismatched << " mismatched" << std::endl;
+
+    bool ok = mismatched == 0 && verified > 0 &&
+              (scenario.conditions.active() || skipped == 0);
+    if (!ok) std::cerr << "FAILED: " << scenario.name << std::endl;
+    return ok;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 5.0;
+
+    std::vector<Scenario> scenarios = {
+        {"clean", {0, 0, 0}},
+        {"lossy", {10, 40, 20}},
+    };
+    bool ok = true;
+    for (const Scenario& scenario : scenarios) {
+        ok &= runScenario(scenario, seconds);
+    }
+    return ok ? 0 : 1;
+}
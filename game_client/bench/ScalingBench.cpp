@@ -0,0 +1,76 @@
+#include "../include/JobSystem.h"
+#include "../include/Random.h"
+#include "../include/Simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+// Scaling report for the parallel simulation passes: runs the same heavy
+// world with job systems of 1 to N threads and checks each run's final state
+// hash against the serial path.
+//
+//     star_defender_scaling_bench [entities] [ticks] [max threads]
+
+namespace {
+
+const int COLUMNS = 1024;
+const int ROWS = 1024;
+
+// Enemies fill the top half and bullets the bottom half, so the two fronts
+// meet and produce a steady stream of hits and particles
+void populate(Simulation& sim, int entities) {
+    Xoshiro256 rng(1);
+    for (int i = 0; i < entities; i++) {
+        sim.spawnEnemy(rng.nextInt(0, COLUMNS - 1), rng.nextInt(0, ROWS / 2 - 1));
+        sim.spawnBullet(rng.nextInt(0, COLUMNS - 1), rng.nextInt(ROWS / 2, ROWS - 2));
+    }
+}
+
+struct Run {
+    double msPerTick;
+    uint64_t hash;
+};
+
+Run runWorld(JobSystem* jobs, int entities, int ticks) {
+    Simulation sim(COLUMNS * Simulation::TILE_SIZE, ROWS * Simulation::TILE_SIZE, 1);
+    sim.setJobSystem(jobs);
+    sim.applyAction(Simulation::Action::CONFIRM);
+    populate(sim, entities);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; i++) {
+        sim.update();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::milli>(end - start).count() / ticks, sim.stateHash()};
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int entities = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 200;
+    unsigned maxThreads = argc > 3 ? std::atoi(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << entities << " enemies and " << entities << " bullets on a " << COLUMNS << "x" << ROWS
+              << " grid, " << ticks << " ticks" << std::endl;
+
+    Run serial = runWorld(nullptr, entities, ticks);
+    std::cout << "threads\tms/tick\tspeedup\tstate" << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "serial\t" << serial.msPerTick << "\t1.00\t-" << std::endl;
+
+    bool allMatch = true;
+    for (unsigned threads = 1; threads <= maxThreads; threads++) {
+        auto jobs = std::make_unique<JobSystem>(threads);
+        Run run = runWorld(jobs.get(), entities, ticks);
+        bool match = run.hash == serial.hash;
+        allMatch &= match;
+        std::cout << threads << "\t" << run.msPerTick << "\t" << std::setprecision(2)
+                  << serial.msPerTick / run.msPerTick << std::setprecision(3) << "\t"
+                  << (match ? "match" : "MISMATCH") << std::endl;
+    }
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,331 @@
+#include "../include/Autopilot.h"
+#include "../include/Simulation.h"
+#include "../include/StateSnapshot.h"
+#include "../include/UploadQueue.h"
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef STAR_DEFENDER_ZLIB
+#include <zlib.h>
+#endif
+
+// Upload queue under backend outages. A stand-in HTTP server on loopback
+// accepts batches, then refuses connections, answers 503 and hangs without
+// answering, while a 60 Hz producer submits game results. Between outages
+// the queue is restarted on a log with a torn final write, as after a crash.
+// Reports the producer's submit cost per phase and fails if any record is
+// lost or any phase's 99th percentile submit exceeds a millisecond. (The
+// maximum is reported but not judged: one preemption would fail the run.)
+//
+//     star_defender_sync_bench [seconds per phase]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class StandInServer {
+public:
+    enum Mode { ACCEPT, REFUSE, ERROR, HANG };
+
+    ~StandInServer() { stop(); }
+
+    bool start() {
+        if (!openListener()) return false;
+        running = true;
+        thread = std::thread([this] { loop(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        thread.join();
+        closeAll();
+    }
+
+    void setMode(Mode value) { mode = value; }
+    int getPort() const { return port; }
+
+    size_t uniqueRecords() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return seen.size();
+    }
+    size_t duplicateRecords() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return duplicates;
+    }
+
+private:
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<Mode> mode{ACCEPT};
+    int listener = -1;
+    int port = 0;
+    std::vector<int> held; // Connections left hanging
+
+    std::mutex mutex;
+    std::set<std::pair<uint64_t, uint64_t>> seen; // (client, sequence)
+    size_t duplicates = 0;
+
+    bool openListener() {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        socklen_t length = sizeof(address);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0 || listen(listener, 16) != 0 ||
+            getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            std::cerr << "Error opening stand-in server: " << std::strerror(errno) << std::endl;
+            ::close(listener);
+            listener = -1;
+            return false;
+        }
+        port = ntohs(address.sin_port);
+        return true;
+    }
+
+    void closeAll() {
+        for (int connection : held) ::close(connection);
+        held.clear();
+        if (listener >= 0) ::close(listener);
+        listener = -1;
+    }
+
+    void loop() {
+        while (running) {
+            Mode current = mode;
+            // A closed listener makes connects fail at once, like a server that is down
+            if (current == REFUSE && listener >= 0) closeAll();
+            if (current != REFUSE && listener < 0 && !openListener()) return;
+            if (current != HANG && !held.empty()) {
+                for (int connection : held) ::close(connection);
+                held.clear();
+            }
+            if (listener < 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+
+            pollfd entry = {listener, POLLIN, 0};
+            if (poll(&entry, 1, 10) != 1) continue;
+            int connection = accept(listener, nullptr, nullptr);
+            if (connection < 0) continue;
+            if (current == HANG) {
+                held.push_back(connection);
+                continue;
+            }
+            std::vector<uint8_t> body;
+            bool gzipped = false;
+            if (readRequest(connection, body, gzipped) && current == ACCEPT && record(body, gzipped)) {
+                respond(connection, "200 OK");
+            } else if (current == ACCEPT) {
+                respond(connection, "400 Bad Request");
+            } else {
+                respond(connection, "503 Service Unavailable");
+            }
+            ::close(connection);
+        }
+    }
+
+    static bool readRequest(int connection, std::vector<uint8_t>& body, bool& gzipped) {
+        std::string data;
+        char buffer[4096];
+        size_t headerEnd = std::string::npos;
+        size_t contentLength = 0;
+        while (true) {
+            pollfd entry = {connection, POLLIN, 0};
+            if (poll(&entry, 1, 1000) != 1) return false;
+            ssize_t count = recv(connection, buffer, sizeof(buffer), 0);
+            if (count <= 0) return false;
+            data.append(buffer, count);
+            if (headerEnd == std::string::npos && (headerEnd = data.find("\r\n\r\n")) != std::string::npos) {
+                std::string headers = data.substr(0, headerEnd);
+                size_t at = headers.find("Content-Length: ");
+                if (at != std::string::npos) contentLength = std::strtoul(headers.c_str() + at + 16, nullptr, 10);
+                gzipped = headers.find("Content-Encoding: gzip") != std::string::npos;
+            }
+            if (headerEnd != std::string::npos && data.size() >= headerEnd + 4 + contentLength) break;
+        }
+        body.assign(data.begin() + headerEnd + 4, data.begin() + headerEnd + 4 + contentLength);
+        return true;
+    }
+
+    static void respond(int connection, const char* status) {
+        std::string response = std::string("HTTP/1.1 ") + status + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        send(connection, response.data(), response.size(), MSG_NOSIGNAL);
+    }
+
+    bool record(std::vector<uint8_t> body, bool gzipped) {
+        if (gzipped) {
+#ifdef STAR_DEFENDER_ZLIB
+            std::vector<uint8_t> plain(1 << 22);
+            z_stream stream = {};
+            inflateInit2(&stream, 15 + 16);
+            stream.next_in = body.data();
+            stream.avail_in = static_cast<uInt>(body.size());
+            stream.next_out = plain.data();
+            stream.avail_out = static_cast<uInt>(plain.size());
+            bool done = inflate(&stream, Z_FINISH) == Z_STREAM_END;
+            plain.resize(stream.total_out);
+            inflateEnd(&stream);
+            if (!done) return false;
+            body.swap(plain);
+#else
+            return false;
+#endif
+        }
+
+        upload::BatchHeader header;
+        if (body.size() < sizeof(header)) return false;
+        std::memcpy(&header, body.data(), sizeof(header));
+        if (std::memcmp(header.magic, upload::MAGIC, 4) != 0) return false;
+        size_t offset = sizeof(header);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < header.count; i++) {
+            upload::BatchRecord record;
+            if (body.size() - offset < sizeof(record)) return false;
+            std::memcpy(&record, body.data() + offset, sizeof(record));
+            offset += sizeof(record) + record.length;
+            if (offset > body.size()) return false;
+            if (!seen.insert({header.clientId, record.sequence}).second) duplicates++;
+        }
+        return true;
+    }
+};
+
+struct Phase {
+    const char* name;
+    StandInServer::Mode mode;
+    std::vector<double> submitMicros;
+};
+
+// Appends a partial entry to the log, as a crash in the middle of a write leaves
+void tearLog(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    const char partial[13] = {40, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    out.write(partial, sizeof(partial));
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    double phaseSeconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+
+    StandInServer server;
+    if (!server.start()) return 1;
+
+    UploadConfig config;
+    config.url = "http://127.0.0.1:" + std::to_string(server.getPort()) + "/api/v1/sync/batch";
+    config.logPath = (std::filesystem::temp_directory_path() / "star_defender_sync_bench.wal").string();
+    config.batchDelayMs = 100;
+    config.initialBackoffMs = 50;
+    config.maxBackoffMs = 500;
+    config.timeoutMs = 250;
+    std::filesystem::remove(config.logPath);
+
+    auto uploads = std::make_unique<UploadQueue>(config);
+    if (!uploads->start()) return 1;
+
+    // A game for the snapshots, stepped once per frame
+    Simulation sim(800, 600, 1);
+    sim.applyAction(Simulation::Action::CONFIRM);
+
+    std::vector<Phase> phases = {
+        {"accepting", StandInServer::ACCEPT, {}},
+        {"refused", StandInServer::REFUSE, {}},
+        {"503", StandInServer::ERROR, {}},
+        {"hanging", StandInServer::HANG, {}},
+        {"recovered", StandInServer::ACCEPT, {}},
+    };
+
+    const auto frameTime = std::chrono::microseconds(1000000 / 60);
+    uint64_t submittedTotal = 0;
+    for (size_t p = 0; p < phases.size(); p++) {
+        Phase& phase = phases[p];
+        server.setMode(phase.mode);
+        if (p == 2) {
+            // Restart mid-outage on a log with a torn tail
+            uploads->stop();
+            submittedTotal += uploads->stats().submitted;
+            tearLog(config.logPath);
+            uploads = std::make_unique<UploadQueue>(config);
+            if (!uploads->start()) return 1;
+        }
+
+        auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(phaseSeconds));
+        auto nextFrame = Clock::now();
+        for (int frame = 0; Clock::now() < end; frame++) {
+            if (sim.getGameState() == Simulation::GAME_OVER) {
+                sim.applyAction(Simulation::Action::CONFIRM);
+                sim.applyAction(Simulation::Action::CONFIRM);
+            }
+            driveAutopilot(sim);
+            sim.update();
+
+            // Ten results a second, each a score and a snapshot, timed as
+            // the game's handler would run them
+            if (frame % 6 == 0) {
+                auto start = Clock::now();
+                uploads->submitScore({sim.getScore(), sim.getTick(), sim.getSeed(), 0});
+                std::vector<uint8_t> snapshot;
+                encodeSnapshot(sim, snapshot);
+                uploads->submitSnapshot(std::move(snapshot));
+                phase.submitMicros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            }
+            nextFrame += frameTime;
+            std::this_thread::sleep_until(nextFrame);
+        }
+    }
+
+    // Let the backlog drain
+    auto deadline = Clock::now() + std::chrono::seconds(30);
+    while (uploads->stats().pending > 0 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    uploads->stop();
+    UploadQueue::Stats stats = uploads->stats();
+    submittedTotal += stats.submitted;
+    server.stop();
+
+    std::cout << std::left << std::setw(12) << "phase" << std::right << std::setw(10) << "submits" << std::setw(12)
+              << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "max us" << std::endl;
+    double worst = 0;
+    for (Phase& phase : phases) {
+        std::vector<double>& samples = phase.submitMicros;
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&](double q) { return samples.empty() ? 0.0 : samples[static_cast<size_t>((samples.size() - 1) * q)]; };
+        worst = std::max(worst, percentile(0.99));
+        std::cout << std::left << std::setw(12) << phase.name << std::right << std::setw(10) << samples.size()
+                  << std::fixed << std::setprecision(1) << std::setw(12) << percentile(0.5) << std::setw(12)
+                  << percentile(0.99) << std::setw(12) << percentile(1.0) << std::endl;
+    }
+
+    size_t received = server.uniqueRecords();
+    std::cout << submittedTotal << " records submitted, " << received << " received, " << server.duplicateRecords()
+              << " duplicates, " << stats.pending << " pending, " << stats.failedAttempts
+              << " failed attempts after the restart" << std::endl;
+
+    bool ok = received == submittedTotal && stats.dropped == 0 && worst < 1000.0;
+    if (!ok) std::cerr << "FAILED: records lost or submits slower than 1 ms at p99" << std::endl;
+    std::filesystem::remove(config.logPath);
+    return ok ? 0 : 1;
+}
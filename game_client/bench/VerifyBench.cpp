@@ -0,0 +1,155 @@
+#include "../include/Autopilot.h"
+#include "../include/InputRecording.h"
+#include "../include/ReplayVerifier.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+// Score verification throughput. Records autopilot games with InputRecorder
+// as the game would, then verifies the genuine claims with 1 to N threads
+// and a set of forged ones: a raised score, another seed, a truncated log
+// and a corrupted hash. Fails if any claim gets the wrong verdict, and
+// prints a digest of every verdict, score and length to compare between
+// compilers and optimisation levels.
+//
+//     star_defender_verify_bench [sessions] [max threads]
+
+namespace {
+
+// Plays one game to its end with policy, recording it to path
+int recordGame(const std::string& path, uint64_t seed, const char* policyName) {
+    VerifyConfig field;
+    Simulation sim(field.width, field.height, seed);
+    std::unique_ptr<AutopilotPolicy> policy = makeAutopilotPolicy(policyName, seed);
+    InputRecorder recorder;
+    recorder.open(path, sim);
+
+    auto apply = [&](Simulation::Action action) {
+        recorder.recordAction(action);
+        sim.applyAction(action);
+    };
+    apply(Simulation::Action::CONFIRM);
+    while (sim.getGameState() == Simulation::PLAYING && sim.getTick() < 100000) {
+        Simulation::Action actions[AutopilotPolicy::MAX_ACTIONS];
+        int count = policy->chooseActions(sim, 0, actions);
+        for (int i = 0; i < count; i++) apply(actions[i]);
+        sim.update();
+        recorder.recordUpdate(sim);
+    }
+    recorder.close(sim);
+    return sim.getScore();
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int sessions = argc > 1 ? std::atoi(argv[1]) : 2000;
+    unsigned maxThreads = argc > 2 ? std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    // Half the games are played well and last, half badly and end quickly
+    std::string path = (std::filesystem::temp_directory_path() / "star_defender_verify_bench.sdrc").string();
+    std::vector<VerifyClaim> claims;
+    uint64_t logBytes = 0;
+    std::cout.setstate(std::ios::failbit); // InputRecorder reports every close
+    for (int i = 0; i < sessions; i++) {
+        uint64_t seed = 1 + i;
+        int score = recordGame(path, seed, i % 2 ? "random" : "sweep");
+        claims.push_back({seed, score, readFile(path)});
+        logBytes += claims.back().log.size();
+    }
+    std::cout.clear();
+    std::filesystem::remove(path);
+    std::printf("%d recorded games, %.0f bytes per log on average\n", sessions,
+                sessions ? static_cast<double>(logBytes) / sessions : 0.0);
+
+    bool allCorrect = true;
+    uint64_t digest = 0xcbf29ce484222325ull;
+    auto mix = [&digest](uint64_t value) {
+        for (int i = 0; i < 8; i++, value >>= 8) digest = (digest ^ (value & 0xff)) * 0x100000001b3ull;
+    };
+
+    std::printf("threads\tclaims/s\tper thread\tupdates/s\n");
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        VerifyConfig config;
+        config.threads = threads;
+        ReplayVerifier verifier(config);
+        std::vector<ReplayVerifier::Result> results;
+        auto start = std::chrono::steady_clock::now();
+        verifier.verify(claims, results);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t updates = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            updates += results[i].updates;
+            if (results[i].verdict != ReplayVerifier::Verdict::ACCEPTED || results[i].score != claims[i].score) {
+                if (allCorrect) std::printf("Genuine claim %zu: %s\n", i, ReplayVerifier::verdictName(results[i].verdict));
+                allCorrect = false;
+            }
+            if (threads == 1) {
+                mix(static_cast<uint64_t>(results[i].verdict));
+                mix(static_cast<uint64_t>(results[i].score));
+                mix(results[i].updates);
+            }
+        }
+        std::printf("%u\t%.0f\t\t%.0f\t\t%.3g\n", threads, claims.size() / seconds, claims.size() / seconds / threads,
+                    updates / seconds);
+        if (threads == maxThreads) break;
+    }
+
+    // Forgeries of the longer games, which have hashes to corrupt
+    std::vector<VerifyClaim> forged;
+    std::vector<ReplayVerifier::Verdict> expected;
+    for (size_t i = 0; i < claims.size() && forged.size() < 400; i += 2) {
+        VerifyClaim claim = claims[i];
+        claim.score += 10;
+        forged.push_back(claim);
+        expected.push_back(ReplayVerifier::Verdict::SCORE_MISMATCH);
+
+        claim = claims[i];
+        claim.seed++;
+        forged.push_back(claim);
+        expected.push_back(ReplayVerifier::Verdict::WRONG_SEED);
+
+        // Without the end marker
+        claim = claims[i];
+        claim.log.resize(claim.log.size() - 2);
+        forged.push_back(claim);
+        expected.push_back(ReplayVerifier::Verdict::MALFORMED);
+
+        // The final hash sits just before the end marker
+        claim = claims[i];
+        claim.log[claim.log.size() - 3] ^= 1;
+        forged.push_back(claim);
+        expected.push_back(ReplayVerifier::Verdict::HASH_MISMATCH);
+    }
+    ReplayVerifier verifier;
+    std::vector<ReplayVerifier::Result> results;
+    verifier.verify(forged, results);
+    int rejected = 0;
+    for (size_t i = 0; i < forged.size(); i++) {
+        rejected += results[i].verdict != ReplayVerifier::Verdict::ACCEPTED;
+        mix(static_cast<uint64_t>(results[i].verdict));
+        if (results[i].verdict != expected[i]) {
+            if (allCorrect) {
+                std::printf("Forged claim %zu: %s, expected %s\n", i, ReplayVerifier::verdictName(results[i].verdict),
+                            ReplayVerifier::verdictName(expected[i]));
+            }
+            allCorrect = false;
+        }
+    }
+    std::printf("%d of %zu forged claims rejected\n", rejected, forged.size());
+    std::printf("Verdict digest: %016llx\n", static_cast<unsigned long long>(digest));
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+// Debug hook counting every global operator new, for checking that the
+// steady-state frame loop does not touch the heap. The replacement operators
+// live in AllocationCounter.cpp, which only executables that want counting
+// compile in; count() is undefined elsewhere.
+namespace allocations {
+
+// Heap allocations on all threads since the program started
+uint64_t count();
+
+}
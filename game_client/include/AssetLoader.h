@@ -0,0 +1,89 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+#include "AssetPack.h"
+#include "Renderer.h"
+#include "ThreadPool.h"
+
+// Loads the game's fonts and textures in the background. Decoding images,
+// opening fonts and rasterizing glyph atlases run on worker threads; the
+// finished surfaces are handed back through poll(), which creates the
+// textures and must be called from the render thread. Fonts and textures
+// complete as two groups so the menu can show before gameplay art is in.
+class AssetLoader {
+public:
+    struct FontRequest {
+        std::string name;
+        std::string file;
+        int size;
+    };
+    struct TextureRequest {
+        std::string name;
+        std::string file;
+    };
+
+    explicit AssetLoader(Renderer* renderer);
+    ~AssetLoader();
+
+    // Queues every request. Assets come from star_defender.pack in basePath
+    // when present, otherwise from loose files in basePath/../assets/.
+    void start(const std::string& basePath, const std::vector<FontRequest>& fonts,
+               const std::vector<TextureRequest>& textures);
+
+    // Uploads finished work and runs completion callbacks; render thread only
+    void poll();
+
+    // Waits for outstanding jobs and releases anything not yet handed over
+    void shutdown();
+
+    // Completion, observable as futures or as callbacks run from poll()
+    std::shared_future<void> fontsReady() const { return fontsDone; }
+    std::shared_future<void> texturesReady() const { return texturesDone; }
+    void onFontsReady(std::function<void()> callback) { fontCallbacks.push_back(std::move(callback)); }
+    void onTexturesReady(std::function<void()> callback) { textureCallbacks.push_back(std::move(callback)); }
+
+    bool areFontsReady() const { return fontsLoaded; }
+    bool areTexturesReady() const { return texturesLoaded; }
+    float getProgress() const { return totalItems ? static_cast<float>(finishedItems) / totalItems : 1.0f; }
+
+private:
+    struct LoadedFont {
+        std::string name;
+        TTF_Font* font;
+        Renderer::GlyphSheet sheet;
+    };
+    struct LoadedImage {
+        std::string name;
+        SDL_Surface* surface;
+    };
+
+    Renderer* renderer;
+    ThreadPool pool;
+    AssetPack assetPack; // Mapped for as long as fonts read from it
+
+    std::future<std::vector<LoadedFont>> pendingFonts;
+    std::vector<std::future<LoadedImage>> pendingImages;
+    std::vector<TextureRequest> packedTextures;
+
+    std::promise<void> fontsPromise;
+    std::promise<void> texturesPromise;
+    std::shared_future<void> fontsDone;
+    std::shared_future<void> texturesDone;
+    std::vector<std::function<void()>> fontCallbacks;
+    std::vector<std::function<void()>> textureCallbacks;
+
+    bool started = false;
+    bool fontsLoaded = false;
+    bool texturesLoaded = false;
+    int fontItems = 0;
+    int totalItems = 0;
+    int finishedItems = 0;
+
+    void uploadPackedTextures();
+    void finishFonts();
+    void finishTextures();
+};
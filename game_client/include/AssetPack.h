@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Single-file asset pack produced by the star_defender_pack tool at build
+// time. Images arrive pre-decoded as RGBA32 pixels packed into one atlas,
+// fonts as their raw file bytes. All fields are fixed-width little-endian so
+// the file can be memory-mapped and read in place.
+//
+// Layout: PackHeader, then entryCount PackEntry records, then the data
+// blobs, each aligned to PACK_ALIGNMENT bytes.
+namespace pack {
+
+const char MAGIC[4] = {'S', 'D', 'P', 'K'};
+const uint32_t VERSION = 1;
+const uint32_t PACK_ALIGNMENT = 16;
+const size_t NAME_LENGTH = 48;
+
+enum EntryType : uint32_t {
+    IMAGE = 1,      // RGBA32 pixels, width * height * 4 bytes
+    REGION = 2,     // Sub-rectangle of the IMAGE entry at index parent; no data
+    FONT = 3        // Raw font file bytes
+};
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct PackEntry {
+    char name[NAME_LENGTH];     // NUL-terminated
+    uint32_t type;
+    uint32_t parent;
+    uint64_t offset;            // From the start of the file
+    uint64_t size;
+    uint32_t x, y;
+    uint32_t width, height;
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader must match the on-disk layout");
+static_assert(sizeof(PackEntry) == 88, "PackEntry must match the on-disk layout");
+
+}
+
+// Read-only view of a pack file, mapped into memory for its whole lifetime
+class AssetPack {
+public:
+    AssetPack() = default;
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // Returns nullptr if no entry has this name
+    const pack::PackEntry* find(const std::string& name) const;
+    const pack::PackEntry* entry(uint32_t index) const;
+    const void* data(const pack::PackEntry& entry) const { return base + entry.offset; }
+    uint32_t size() const { return entryCount; }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+    const pack::PackEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
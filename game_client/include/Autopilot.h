@@ -0,0 +1,40 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "Random.h"
+#include "Simulation.h"
+
+// Scripted player for unattended runs: chases the lowest enemy and keeps
+// firing so that collisions and particles are exercised. Does nothing
+// outside the PLAYING state.
+void driveAutopilot(Simulation& sim, int player = 0);
+
+// The actions driveAutopilot would apply for a player, for callers that send
+// them elsewhere (a network client); returns how many were written
+int chooseAutopilotActions(const Simulation& sim, int player, Simulation::Action actions[2]);
+
+// A way of playing, asked for a player's actions once per tick. Policies may
+// keep state, but it must follow only from the game and their own seed, so
+// that a session replays from its seed. One instance plays one session.
+class AutopilotPolicy {
+public:
+    static const int MAX_ACTIONS = 2;
+
+    virtual ~AutopilotPolicy() = default;
+
+    // Writes up to MAX_ACTIONS actions for player; returns how many. Only
+    // called in the PLAYING state.
+    virtual int chooseActions(const Simulation& sim, int player, Simulation::Action actions[MAX_ACTIONS]) = 0;
+
+    // Applies this tick's actions; does nothing outside the PLAYING state
+    void drive(Simulation& sim, int player = 0);
+};
+
+// Built-in policies by name, seeded for those that make random choices:
+//   human   chases with a reaction time, hesitation and unsteady fire
+//   chase   as driveAutopilot; never loses
+//   sweep   walks from wall to wall, firing every tick
+//   random  moves and fires at random
+// Returns null for an unknown name.
+std::unique_ptr<AutopilotPolicy> makeAutopilotPolicy(const std::string& name, uint64_t seed);
+const char* autopilotPolicyNames();
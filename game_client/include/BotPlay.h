@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Simulation;
+
+// Monte Carlo play for balancing and long-game performance: many independent
+// sessions, each a fresh Simulation with its own seed played by an autopilot
+// policy from the menu to game over, run concurrently without rendering.
+// Outcomes depend only on the config, never on the number of threads;
+// timings are gathered per thread and merged.
+struct BotPlayConfig {
+    int sessions = 1000;
+    uint64_t seed = 1;              // Session i plays seed + i
+    std::string policy = "human";
+    int columns = 16;
+    int rows = 12;
+    long maxTicks = 100000;         // Sessions still playing then are cut off
+    unsigned threads = 0;           // Zero: one per hardware thread
+};
+
+class BotPlay {
+public:
+    struct Session {
+        uint64_t seed;
+        int score;
+        long ticks;
+        bool cutOff;
+        size_t peakEnemies;
+        size_t peakBullets;
+        size_t peakParticles;
+        size_t peakEntities;        // Most of all three at once
+    };
+
+    // Tick cost histogram in powers of two: bucket 0 is under 1 ns, bucket b
+    // covers [2^(b-1), 2^b) ns and the last is everything longer
+    static const int COST_BUCKETS = 32;
+
+    explicit BotPlay(const BotPlayConfig& config);
+
+    // Plays every session; false if the policy is unknown
+    bool run();
+
+    const BotPlayConfig& getConfig() const { return config; }
+    const std::vector<Session>& getSessions() const { return sessions; }
+    double getSeconds() const { return seconds; }
+    unsigned getThreads() const { return threads; }
+    double sessionsPerSecond() const { return seconds > 0 ? sessions.size() / seconds : 0; }
+
+    // Over every session's seed, score and length in order; equal runs of
+    // the same config agree whatever their thread counts
+    uint64_t resultHash() const;
+
+    void report(std::ostream& out) const;
+
+private:
+    // A cache line each, so workers' counts never share one
+    struct alignas(64) Worker {
+        uint64_t tickCost[COST_BUCKETS] = {};
+        uint64_t ticks = 0;
+    };
+
+    BotPlayConfig config;
+    std::vector<Session> sessions;
+    uint64_t tickCost[COST_BUCKETS] = {};
+    uint64_t ticks = 0;
+    double seconds = 0;
+    unsigned threads = 0;
+
+    void playSession(int index, Simulation& sim, Worker& worker);
+};
@@ -1,7 +0,0 @@
-#pragma once
-class Bullet{
-public:
-    int x,y;
-    bool dead;
-    Bullet(int x, int y);
-};
\ No newline at end of file
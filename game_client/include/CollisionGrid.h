@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "EntityStore.h"
+
+// A bullet and an enemy occupying the same cell, by index into their stores
+struct Hit {
+    int bullet;
+    int enemy;
+};
+
+// Reference collision pass: compares every bullet against every enemy.
+// Hits are reported bullet-major, enemy-minor.
+void findHitsNestedLoop(const EntityStore& bullets, const EntityStore& enemies, std::vector<Hit>& hits);
+
+// Bitboard collision engine. Enemies and bullets are stored as one bit per
+// grid cell in per-row bitmasks; ANDing the two boards finds every occupied
+// cell in a handful of word operations, independent of how many entities
+// there are. Hits map back to entities through a per-cell enemy chain and are
+// reported in the same order as findHitsNestedLoop.
+class CollisionGrid {
+public:
+    CollisionGrid(int columns = 0, int rows = 0);
+
+    void resize(int columns, int rows);
+    void findHits(const EntityStore& bullets, const EntityStore& enemies, std::vector<Hit>& hits);
+
+    // findHits in two steps for parallel use: prepare() fills the boards and
+    // returns whether any cell is shared; collectHits() then appends the hits
+    // of bullets [begin, end) and may run for disjoint ranges concurrently.
+    // Collecting consecutive ranges in order gives the findHits order.
+    bool prepare(const EntityStore& bullets, const EntityStore& enemies);
+    void collectHits(const EntityStore& bullets, size_t begin, size_t end, std::vector<Hit>& hits) const;
+
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+
+private:
+    int columns;
+    int rows;
+    int wordsPerRow;
+
+    // Occupancy bitboards, rows * wordsPerRow words each
+    std::vector<uint64_t> enemyBoard;
+    std::vector<uint64_t> bulletBoard;
+    std::vector<uint64_t> hitBoard;
+
+    // First enemy in each cell and the next enemy in the same cell, -1 terminated
+    std::vector<int> cellHead;
+    std::vector<int> nextEnemy;
+
+    bool inBounds(int x, int y) const { return x >= 0 && x < columns && y >= 0 && y < rows; }
+    int cellIndex(int x, int y) const { return y * columns + x; }
+    size_t wordIndex(int x, int y) const { return static_cast<size_t>(y) * wordsPerRow + (x >> 6); }
+    static uint64_t bitMask(int x) { return uint64_t(1) << (x & 63); }
+
+    void clear();
+    bool intersect();
+};
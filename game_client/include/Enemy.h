@@ -1,7 +0,0 @@
-#pragma once
-class Enemy {
-public:
-    int x,y;
-    bool dead;
-    Enemy(int x, int y);
-};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Stable reference to an entity that survives other entities being removed
+struct EntityHandle {
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// Structure-of-arrays storage for grid entities (enemies and bullets).
+// Positions live in packed int16_t columns and liveness in a separate bitset,
+// so the per-tick movement passes touch only the column they change and
+// compile to straight vector loops. Entities are kept densely packed: removal
+// moves the last entity into the hole (swap-and-pop), so dense indices are
+// not stable across removals but handles are.
+class EntityStore {
+public:
+    EntityStore() = default;
+
+    // Spawning and removal
+    EntityHandle spawn(int x, int y);
+    void despawn(size_t index);
+    void clear();
+
+    // Preallocates room for capacity entities, so that spawning up to that
+    // many never touches the heap
+    void reserve(size_t capacity);
+
+    // Replaces the contents with count live entities at the given current
+    // and previous positions, as when loading a saved state
+    void assign(const int16_t* x, const int16_t* y, const int16_t* prevX, const int16_t* prevY, size_t count);
+
+    // Mark an entity dead; it stays in place until removeDead()
+    void kill(size_t index) { alive[index >> 6] &= ~(uint64_t(1) << (index & 63)); }
+    bool isAlive(size_t index) const { return (alive[index >> 6] >> (index & 63)) & 1; }
+
+    // Kill every live entity for which pred(x, y) holds; returns how many.
+    // Ranges that run concurrently must start at multiples of 64, as
+    // liveness is stored 64 entities to a word.
+    template <typename Pred>
+    int killIf(Pred pred) { return killIf(pred, 0, xs.size()); }
+    template <typename Pred>
+    int killIf(Pred pred, size_t begin, size_t end);
+    void removeDead();
+
+    // Handle lookup; returns -1 once the entity has been removed
+    long find(EntityHandle handle) const;
+    EntityHandle getHandle(size_t index) const { return {denseToSlot[index], slotGeneration[denseToSlot[index]]}; }
+
+    // Batch passes, whole store or an index range
+    void moveY(int dy) { moveY(dy, 0, xs.size()); }
+    void moveY(int dy, size_t begin, size_t end);
+    void savePreviousPositions() { savePreviousPositions(0, xs.size()); }
+    void savePreviousPositions(size_t begin, size_t end);
+
+    // Column access
+    size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+    int getX(size_t index) const { return xs[index]; }
+    int getY(size_t index) const { return ys[index]; }
+    int getPrevX(size_t index) const { return prevXs[index]; }
+    int getPrevY(size_t index) const { return prevYs[index]; }
+    const int16_t* xData() const { return xs.data(); }
+    const int16_t* yData() const { return ys.data(); }
+    const int16_t* prevXData() const { return prevXs.data(); }
+    const int16_t* prevYData() const { return prevYs.data(); }
+
+private:
+    // Dense columns, indexed by position in the store
+    std::vector<int16_t> xs;
+    std::vector<int16_t> ys;
+    std::vector<int16_t> prevXs; // Position at the start of the last tick, for interpolation
+    std::vector<int16_t> prevYs;
+    std::vector<uint64_t> alive;
+
+    // Handle indirection
+    std::vector<uint32_t> denseToSlot;
+    std::vector<uint32_t> slotToDense;
+    std::vector<uint32_t> slotGeneration;
+    std::vector<uint32_t> freeSlots;
+
+    void setAlive(size_t index, bool value);
+};
+
+template <typename Pred>
+int EntityStore::killIf(Pred pred, size_t begin, size_t end) {
+    int killed = 0;
+    for (size_t i = begin; i < end; i++) {
+        if (isAlive(i) && pred(xs[i], ys[i])) {
+            kill(i);
+            killed++;
+        }
+    }
+    return killed;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// Bump allocator for data that lives for one frame, such as formatted text.
+// Allocations are carved from one block reserved up front and all released
+// at once by reset(), so the frame loop never touches the heap for them.
+// Nothing is destructed; only trivially destructible data belongs here.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Null once the block is full; the overflow is counted for highWater()
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    template <typename T>
+    T* allocateArray(size_t count) { return static_cast<T*>(allocate(sizeof(T) * count, alignof(T))); }
+
+    // printf into the arena; the result is valid until reset(), and
+    // truncated to what fits if the arena is nearly full
+    std::string_view format(const char* fmt, ...);
+
+    void reset();
+
+    size_t capacity() const { return size; }
+    size_t used() const { return offset; }
+    size_t highWater() const { return peak; } // Most requested in one frame, overflow included
+
+private:
+    std::unique_ptr<uint8_t[]> block;
+    size_t size;
+    size_t offset = 0;
+    size_t requested = 0;
+    size_t peak = 0;
+};
@@ -2,82 +2,192 @@
 #include <vector>
 #include <string>
 #include <SDL3/SDL.h>
-#include "Player.h"
-#include "Enemy.h"
-#include "Bullet.h"
+#include "Simulation.h"
 #include "Renderer.h"
+#include "AssetLoader.h"
+#include "InputRecording.h"
+#include "LatencyTracker.h"
+#include "NetSession.h"
+#include "RenderBackend.h"
+#include "SimSnapshot.h"
+#include "SimulationThread.h"
+#include "StressTest.h"
+#include "UploadQueue.h"
 
-class Game {
+class Game : public RenderBackend {
 private:
     int width;
     int height;
     bool running;
-    int tick;
-    int score;
-    float difficulty;
-    int enemiesSpawned;
-    
-    // Game state
-    enum GameState {
-        MENU,
-        PLAYING,
-        GAME_OVER,
-        PAUSED
-    };
-    GameState currentState;
+    
+    // Time spent playing, drives the background scroll; other screens hold
+    // still so that they need no redraw
+    double elapsedSeconds;
     
     // SDL3 components
     SDL_Window* window;
     Renderer* renderer;
     
-    // Game entities
-    Player player;
-    std::vector<Enemy> enemies;
-    std::vector<Bullet> bullets;
-    
-    // Particle system for visual effects
-    struct Particle {
-        float x, y;
-        float vx, vy;
-        int life;
-        Uint8 r, g, b;
+    // Background asset streaming
+    AssetLoader* assetLoader;
+    bool firstFrameShown = false;
+    
+    // F3 frame profiler overlay
+    bool showProfiler = false;
+    
+    // Sprite textures
+    Renderer::TextureHandle playerTexture;
+    Renderer::TextureHandle enemyTexture;
+    Renderer::TextureHandle bulletTexture;
+    Renderer::TextureHandle backgroundTexture;
+    
+    // Cached layers: the background strip and screens that change only with
+    // the score or the state, redrawn when their inputs change
+    Renderer::LayerHandle backgroundLayer;
+    Renderer::LayerHandle hudLayer;
+    Renderer::LayerHandle menuLayer;
+    Renderer::LayerHandle pausedLayer;
+    Renderer::LayerHandle gameOverLayer;
+    
+    // Game rules and entities, with workers for the per-entity passes
+    JobSystem jobs;
+    Simulation sim;
+    
+    // Optional log of every action for later replay
+    InputRecorder recorder;
+    
+    // Runs sim and recorder while run() is active
+    SimulationThread simThread;
+    
+    // Snapshot for frames driven by step() on this thread
+    SimSnapshot stepSnapshot;
+    
+    // Set while runClient() is active; actions go to the host instead
+    NetClient* netClient = nullptr;
+    
+    // Actions queued to simThread so far, and with enableLatencyTracking()
+    // the input time of each until a presented frame includes it
+    uint32_t actionsPushed = 0;
+    bool trackLatency = false;
+    LatencyTracker latency;
+    
+    // Low-latency input: movement keys are sampled every frame and repeat at
+    // moveInterval while held, instead of at the OS key repeat rate
+    struct HeldKey {
+        SDL_Scancode scancode;
+        Simulation::Action action;
+        bool held;
+        Uint64 nextStep;    // SDL_GetTicksNS time of the next move
     };
-    std::vector<Particle> particles;
+    bool lowLatencyInput = false;
+    Uint64 moveInterval = 0;
+    HeldKey heldKeys[2] = {
+        {SDL_SCANCODE_A, Simulation::Action::MOVE_LEFT, false, 0},
+        {SDL_SCANCODE_D, Simulation::Action::MOVE_RIGHT, false, 0},
+    };
+    
+    // Idle-aware loop: screens outside play are drawn only when they change,
+    // and run() sleeps on the event queue in between
+    bool idleWait = true;
+    bool redrawRequested = false;   // The window's contents were lost
     
     // Coordinate conversion
-    static const int TILE_SIZE = 48; // Each game tile is 48x48 pixels
+    static const int TILE_SIZE = Simulation::TILE_SIZE;
+    
+    // Background scroll speed in pixels per second
+    static constexpr float BACKGROUND_SCROLL_SPEED = 6.0f;
 
 public:
-    Game(SDL_Window* window, int width=800, int height=600);
+    // Activity of run(), to show what an idle game costs. Wakeups count the
+    // render loop's iterations and the simulation thread's; the idle figures
+    // cover time on screens outside play once assets have loaded.
+    struct LoopStats {
+        double seconds;
+        double cpuSeconds;          // Process CPU time, all threads
+        uint64_t wakeups;
+        uint64_t frames;
+        double idleSeconds;
+        double idleCpuSeconds;
+        uint64_t idleWakeups;
+    };
+    
+    Game(SDL_Window* window, int width=800, int height=600, uint64_t seed=0);
     ~Game();
     void run();
+    
+    // Logs the seed and every action from now on; call before run()
+    bool startRecording(const std::string& path);
+    
+    // Submits each finished game's score and final state to uploads, which
+    // must be started and outlive run(); call before run()
+    void enableUploads(UploadQueue& uploads);
+    
+    // Records the time from each input event to the present of the first
+    // frame that shows its effect; call before run()
+    void enableLatencyTracking() { trackLatency = true; }
+    LatencyTracker::Summary getLatency() const { return latency.summary(); }
+    
+    // Samples held movement keys each frame, moving movesPerSecond times a
+    // second, and has run() wait for the simulation thread to apply each
+    // frame's input before drawing it; call before run()
+    void enableLowLatencyInput(double movesPerSecond);
+    
+    // Draws every frame, as fast as vsync allows, even when nothing has
+    // changed; for comparison with the idle-aware loop. Call before run().
+    void disableIdleWait() { idleWait = false; }
+    const LoopStats& getLoopStats() const { return loopStats; }
+    
+    // Runs the simulation thread's network hooks for host, which must be
+    // open and outlive run(); call before run()
+    void enableHosting(NetHost& host);
+    
+    // Instead of run(): plays in the game client has joined, rendering its
+    // mirrored world until the window is closed or the connection drops
+    void runClient(NetClient& client);
+    
+    // Instead of run(): renders stress's world, one tick per frame, as fast
+    // as possible until the stress test finishes or the window is closed
+    void runStress(StressTest& stress);
+    
+    // Advances ticks simulation steps and draws one frame without polling
+    // events or the simulation thread; lets tools drive the game frame by frame
+    void step(int ticks, float alpha);
+    
+    // Draws snapshot with SDL and presents it
+    void drawFrame(const SimSnapshot& snapshot, float alpha) override;
+    bool assetsReady() const { return assetLoader->areFontsReady() && assetLoader->areTexturesReady(); }
+    Simulation& getSimulation() { return sim; } // Not while run() is active
+    const Renderer& getRenderer() const { return *renderer; }
 
 private:
+    LoopStats loopStats = {};
+    
+    void loadAssets();
     void processInput();
+    void pressMoveKey(HeldKey& key, Uint64 timestamp);
+    void sampleHeldKeys();
+    void applyAction(Simulation::Action action, Uint64 inputTime);
     void update();
-    void render();
-    void spawnEnemies();
-    void reset();
     
-    // Game state management
-    void setGameState(GameState newState);
+    // Game state rendering; the static parts are drawn into layers
+    void renderBackground();
+    void renderHud(int score);
     void renderMenu();
-    void renderGameplay();
-    void renderGameOver();
+    void renderLoading();
+    void renderGameplay(const SimSnapshot& snapshot, float alpha);
+    void renderGameOver(const SimSnapshot& snapshot);
     void renderPaused();
+    void renderProfilerOverlay();
     
     // Particle system
-    void addParticle(float x, float y, float vx, float vy, Uint8 r, Uint8 g, Uint8 b, int life = 30);
-    void updateParticles();
-    void renderParticles();
-    
-    // Enhanced collision detection
-    void removeOffScreenBullets();
-    void createHitEffect(int x, int y);
+    void renderParticles(const SimSnapshot& snapshot, float alpha);
     
     // Helper functions for coordinate conversion
-    float gameToPixelX(int gameX) const { return gameX * TILE_SIZE; }
-    float gameToPixelY(int gameY) const { return gameY * TILE_SIZE; }
-    int pixelToGameX(float pixelX) const { return static_cast<int>(pixelX / TILE_SIZE); }
-    int pixelToGameY(float pixelY) const { return static_cast<int>(pixelY / TILE_SIZE); }
+    float gameToPixelX(int gameX) const { return Simulation::gameToPixelX(gameX); }
+    float gameToPixelY(int gameY) const { return Simulation::gameToPixelY(gameY); }
+    
+    // Pixel position blended between the previous and current tick
+    float lerpToPixel(int prev, int current, float alpha) const {
+        return (prev + (current - prev) * alpha) * TILE_SIZE;
+    }
 };
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal blocking HTTP/1.1 client for background workers: plain http, one
+// request per connection, and a single deadline covering connect, send and
+// the response headers. TLS is left to a reverse proxy in front of the
+// backend.
+struct HttpUrl {
+    std::string host;
+    std::string port = "80";
+    std::string path = "/";
+
+    // Accepts http://host[:port][/path]
+    bool parse(const std::string& url);
+};
+
+struct HttpResponse {
+    int status = 0;             // 0 when no response arrived
+    int retryAfterSeconds = -1; // Retry-After in seconds, if sent
+    std::string error;          // Why no response arrived
+};
+
+using HttpHeaders = std::vector<std::pair<std::string, std::string>>;
+
+HttpResponse httpPost(const HttpUrl& url, const HttpHeaders& headers, const void* body, size_t size, int timeoutMs);
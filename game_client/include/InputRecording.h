@@ -0,0 +1,94 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+
+// Compact binary log of one session: the simulation seed plus every player
+// action, timestamped by the number of simulation updates that preceded it,
+// with a state hash every HASH_INTERVAL updates. Replaying the actions at
+// the same update counts reproduces the session exactly.
+//
+// Layout: RecordingHeader, then records of a varint update delta (from the
+// previous record) followed by a tag byte. Tags below TAG_HASH are
+// Simulation::Action values; TAG_HASH is followed by an 8-byte little-endian
+// hash; TAG_END closes the log. The header and hashes are written as they
+// sit in memory, which is little-endian on every supported target.
+namespace recording {
+
+static_assert(std::endian::native == std::endian::little, "recordings are stored in host byte order");
+
+const char MAGIC[4] = {'S', 'D', 'R', 'C'};
+const uint32_t VERSION = 1;
+const uint32_t HASH_INTERVAL = 60;  // Five seconds of play at 12 Hz
+const uint8_t TAG_HASH = 0xf0;
+const uint8_t TAG_END = 0xff;
+
+struct RecordingHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t seed;
+    uint16_t width;
+    uint16_t height;
+    uint32_t hashInterval;
+};
+
+}
+
+class InputRecorder {
+public:
+    ~InputRecorder();
+
+    bool open(const std::string& path, const Simulation& sim);
+    bool isOpen() const { return out.is_open(); }
+
+    // Call for each action applied, and after each Simulation::update()
+    void recordAction(Simulation::Action action);
+    void recordUpdate(const Simulation& sim);
+
+    // Writes a final hash and the end marker
+    bool close(const Simulation& sim);
+
+private:
+    std::ofstream out;
+    uint64_t updates = 0;
+    uint64_t lastRecord = 0;
+    uint64_t actions = 0;
+
+    void writeRecord(uint8_t tag);
+};
+
+class InputReplay {
+public:
+    struct Result {
+        uint64_t updates = 0;
+        uint64_t actions = 0;
+        uint64_t hashesChecked = 0;
+        int64_t mismatchAt = -1;    // Update count of the first differing hash
+        bool complete = false;      // The end marker was reached
+        bool malformed = false;     // Stopped at a tag no recorder writes
+        bool overLimit = false;     // Stopped at maxUpdates
+    };
+
+    bool open(const std::string& path);
+
+    // As open(), for a recording already in memory; returns null, or why
+    // data is not a recording this build can replay. Prints nothing, for
+    // callers checking untrusted input.
+    const char* load(const uint8_t* data, size_t size);
+
+    uint64_t getSeed() const { return header.seed; }
+    int getWidth() const { return header.width; }
+    int getHeight() const { return header.height; }
+
+    // Feeds the log to sim, which must be freshly built from the header, as
+    // fast as possible; stops at the first hash mismatch, or before update
+    // maxUpdates + 1, which a log's update deltas could otherwise put far off
+    Result run(Simulation& sim, uint64_t maxUpdates = UINT64_MAX) const;
+
+private:
+    recording::RecordingHeader header = {};
+    std::vector<uint8_t> body;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing scheduler for data-parallel loops. parallelFor splits a range
+// into grain-sized chunks and deals them out in contiguous blocks, one deque
+// per thread; each thread works through its own block from the back and,
+// once empty, steals from the front of the others. The calling thread takes
+// part, so a JobSystem of N threads runs N - 1 workers.
+//
+// parallelFor may be called from one thread at a time and must not nest.
+class JobSystem {
+public:
+    // Zero picks one thread per hardware thread
+    explicit JobSystem(unsigned threads = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    size_t getThreadCount() const { return queues.size(); }
+
+    // Calls fn(begin, end) for consecutive ranges covering [0, count) and
+    // returns once all have run. Ranges start at multiples of grain.
+    template <typename F>
+    void parallelFor(size_t count, size_t grain, F&& fn);
+
+private:
+    struct Task {
+        void (*run)(void* context, size_t begin, size_t end);
+        void* context;
+        size_t begin;
+        size_t end;
+    };
+
+    struct alignas(64) TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues; // Index 0 belongs to the caller
+    std::vector<std::thread> workers;
+    std::atomic<size_t> remaining{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeWorkers;
+    uint64_t epoch = 0;
+    bool stopping = false;
+
+    void dispatch(void (*run)(void*, size_t, size_t), void* context, size_t count, size_t grain);
+    bool runOne(size_t self);
+    void workerLoop(size_t self);
+};
+
+template <typename F>
+void JobSystem::parallelFor(size_t count, size_t grain, F&& fn) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    if (queues.size() == 1 || count <= grain) {
+        fn(size_t(0), count);
+        return;
+    }
+    using Body = std::remove_reference_t<F>;
+    dispatch([](void* context, size_t begin, size_t end) { (*static_cast<Body*>(context))(begin, end); },
+             const_cast<void*>(static_cast<const void*>(&fn)), count, grain);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size record of millisecond latencies, for counters kept over a
+// whole session. Buckets grow geometrically, 16 to a doubling from 1 us, so
+// a percentile is within about 4.5% of the true value however many samples
+// were added; the maximum is exact. Histograms merge by adding buckets.
+class LatencyHistogram {
+public:
+    void add(double ms);
+    void merge(const LatencyHistogram& other);
+
+    size_t count() const { return total; }
+    double max() const { return largest; }
+
+    // Upper edge of the bucket holding the q quantile, at most max(); 0
+    // when empty
+    double percentile(double q) const;
+
+private:
+    static const int STEPS_PER_DOUBLING = 16;
+    static const int BUCKETS = 32 * STEPS_PER_DOUBLING; // Up to about 70 minutes
+    static constexpr double MIN_MS = 0.001;
+
+    std::array<uint64_t, BUCKETS> buckets = {};
+    size_t total = 0;
+    double largest = 0;
+};
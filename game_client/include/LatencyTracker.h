@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include "LatencyHistogram.h"
+
+// Time from an input to the first presented frame whose state includes it.
+// Inputs are numbered in the order they are queued to the simulation, and a
+// frame reports how many of them its snapshot had applied, so every input up
+// to that number is resolved by its present. Times are nanoseconds on any
+// one clock.
+class LatencyTracker {
+public:
+    struct Summary {
+        double p50;
+        double p95;
+        double p99;
+        double max;
+        size_t inputs;
+    };
+
+    void inputQueued(uint32_t sequence, int64_t inputTime);
+    void framePresented(uint32_t appliedSequence, int64_t presentTime);
+
+    // Milliseconds over every resolved input, percentiles to the histogram's
+    // bucket precision
+    Summary summary() const;
+
+private:
+    struct Pending {
+        uint32_t sequence;
+        int64_t inputTime;
+    };
+
+    std::deque<Pending> pending;
+    LatencyHistogram samples;
+};
@@ -0,0 +1,244 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "LatencyHistogram.h"
+#include "NetSocket.h"
+#include "Simulation.h"
+
+// LAN co-op over UDP. The host runs the only authoritative simulation and
+// sends every tick's state to each client as a delta against the last frame
+// that client acknowledged, so a lost packet costs nothing but a larger next
+// delta. Clients send their actions, repeated until acknowledged, and
+// predict their own ship until the host's state catches up.
+//
+// Every packet starts with a PacketHeader. A frame's payload is the tick's
+// hit count and hit positions (int16 pairs), then the full snapshot when
+// baseFrame is 0 or else a delta against baseFrame; it is split into
+// fragments of at most MAX_FRAGMENT bytes.
+namespace net {
+
+const char MAGIC[4] = {'S', 'D', 'N', 'P'};
+const uint16_t VERSION = 1;
+const uint16_t DEFAULT_PORT = 7777;
+const size_t MAX_PACKET = 1400;
+const size_t MAX_FRAGMENT = 1100;
+const size_t MAX_FRAME = 1 << 20;
+const int MAX_INPUTS = 32;          // Unacknowledged actions carried per input packet
+const int FRAME_HISTORY = 64;       // Frames kept on both sides as delta bases
+const int TIMEOUT_MS = 5000;
+
+enum PacketType : uint8_t {
+    CONNECT = 1,    // ConnectPacket, client to host until welcomed
+    WELCOME,        // WelcomePacket
+    REJECT,         // ConnectPacket; the game is full or a different size
+    INPUT,          // InputPacket, then count actions of one byte each
+    STATE,          // StatePacket, then one fragment of a frame
+    DISCONNECT      // ConnectPacket
+};
+
+#pragma pack(push, 1)
+struct PacketHeader {
+    char magic[4];
+    uint16_t version;
+    uint8_t type;
+    uint8_t reserved;
+};
+
+struct ConnectPacket {
+    PacketHeader header;
+    uint64_t nonce;         // Picked by the client; tells its sessions apart
+    int32_t width;
+    int32_t height;
+};
+
+struct WelcomePacket {
+    PacketHeader header;
+    uint64_t nonce;
+    uint8_t player;
+};
+
+struct InputPacket {
+    PacketHeader header;
+    uint64_t nonce;
+    uint32_t ackFrame;      // Newest frame the client has decoded
+    uint32_t firstSequence; // Sequence number of the first action; they count up from 1
+    int64_t sentAt;         // Client clock, echoed back for the round-trip time
+    uint8_t count;
+};
+
+struct StatePacket {
+    PacketHeader header;
+    uint32_t frame;
+    uint32_t baseFrame;     // 0 for a full snapshot
+    uint32_t inputAck;      // Highest action sequence applied from this client
+    int64_t echoSentAt;     // sentAt of the client's latest input packet...
+    uint32_t echoHeldUs;    // ...and how long the host held it before this reply
+    uint32_t size;          // Whole frame payload
+    uint16_t fragment;
+    uint16_t fragments;
+};
+#pragma pack(pop)
+
+}
+
+// Authoritative side. poll() and afterUpdate() run on the simulation thread;
+// see SimulationThread::setNetworkHandlers.
+class NetHost {
+public:
+    struct Stats {
+        uint64_t frames;            // Ticks encoded
+        uint64_t framesSent;        // Summed over clients
+        uint64_t fullFrames;        // Sent without a usable base
+        uint64_t throttledFrames;   // Skipped because a client's byte budget ran out
+        uint64_t bytesSent;         // UDP payload, all clients
+        int clients;
+    };
+
+    // Each client is sent at most bytesPerSecond on average, with bursts of
+    // up to a second's worth
+    explicit NetHost(int bytesPerSecond = 64 * 1024);
+    NetHost(const NetHost&) = delete;
+    NetHost& operator=(const NetHost&) = delete;
+
+    bool open(uint16_t port);
+    void setConditions(const LinkConditions& conditions, uint64_t seed) { socket.setConditions(conditions, seed); }
+    uint16_t getPort() const { return socket.getPort(); }
+
+    // Handles connections and applies client actions; true if sim changed
+    bool poll(Simulation& sim);
+
+    // Encodes the tick just run and sends it to every client
+    void afterUpdate(const Simulation& sim);
+
+    // Only while the simulation thread is stopped
+    Stats stats() const;
+    const std::vector<uint8_t>* stateAt(uint32_t frame) const;
+    uint32_t getFrame() const { return frame; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Client {
+        NetAddress address;
+        uint64_t nonce = 0;
+        int player = -1;
+        uint32_t ackFrame = 0;
+        uint32_t lastSequence = 0;
+        int64_t echoSentAt = 0;
+        Clock::time_point echoReceived;
+        Clock::time_point lastHeard;
+        double tokens = 0;
+        Clock::time_point tokensAt;
+    };
+
+    struct Frame {
+        uint32_t frame = 0;
+        std::vector<uint8_t> bytes;
+    };
+
+    UdpSocket socket;
+    int bytesPerSecond;
+    std::vector<Client> clients;
+    Frame frames[net::FRAME_HISTORY];
+    uint32_t frame = 0;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> delta;
+    std::vector<uint8_t> packet;
+    Stats counters = {};
+
+    void handleConnect(Simulation& sim, const NetAddress& from, const uint8_t* data, size_t size);
+    bool handleInput(Simulation& sim, Client& client, const uint8_t* data, size_t size);
+    void sendFrame(Client& client, const Simulation& sim);
+};
+
+// One player's view of a hosted game, polled from the game's main thread.
+// The mirrored simulation is only ever restored from the host's frames,
+// apart from the own ship moving ahead of them.
+class NetClient {
+public:
+    struct Stats {
+        uint64_t frames;            // Decoded and applied
+        uint64_t framesSkipped;     // Never applied: lost, superseded or not sent
+        uint64_t framesDropped;     // Of those, received in part or against a base no longer held
+        uint64_t corrections;       // Host state disagreed with the predicted ship
+        uint64_t actionsSent;
+        LatencyHistogram roundTripMs;
+        LatencyHistogram inputLatencyMs;    // Action to the first frame that includes it
+    };
+
+    NetClient(int width, int height);
+    NetClient(const NetClient&) = delete;
+    NetClient& operator=(const NetClient&) = delete;
+
+    void setConditions(const LinkConditions& conditions, uint64_t seed) { socket.setConditions(conditions, seed); }
+
+    // Blocks for the handshake, retrying every 250 ms until timeoutMs
+    bool connect(const NetAddress& host, int timeoutMs);
+    void disconnect();
+    bool isConnected() const { return connected; }
+
+    // Receives whatever arrived; true if a new frame was applied. Drops the
+    // connection after TIMEOUT_MS without a frame.
+    bool poll();
+
+    // Sends the action and, for movement, applies it to the own ship at once
+    void sendAction(Simulation::Action action);
+
+    void wait(int timeoutMs) { socket.wait(timeoutMs); }
+
+    const Simulation& getSimulation() const { return sim; }
+    int getPlayer() const { return player; }
+    uint32_t getFrame() const { return frame; }
+    int64_t getFrameTime() const { return frameTime; } // steady_clock ns at which the newest frame arrived
+    const std::vector<uint8_t>* stateAt(uint32_t frame) const;
+    const Stats& stats() const { return counters; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        uint32_t sequence;
+        Simulation::Action action;
+        int64_t sentAt;
+    };
+
+    struct Frame {
+        uint32_t frame = 0;
+        std::vector<uint8_t> bytes;
+    };
+
+    // Fragments of the newest frame being received
+    struct Assembly {
+        uint32_t frame = 0;
+        uint32_t baseFrame = 0;
+        uint16_t fragments = 0;
+        uint16_t received = 0;
+        uint32_t inputAck = 0;
+        std::vector<uint8_t> have;
+        std::vector<uint8_t> bytes;
+    };
+
+    UdpSocket socket;
+    NetAddress host;
+    uint64_t nonce = 0;
+    bool connected = false;
+    int player = 0;
+    Simulation sim;
+
+    uint32_t frame = 0;
+    int64_t frameTime = 0;
+    Frame frames[net::FRAME_HISTORY];
+    Assembly assembly;
+    std::vector<uint8_t> decoded;
+
+    std::vector<Pending> pending;
+    uint32_t nextSequence = 1;
+    Clock::time_point lastSent;
+    Clock::time_point lastFrameAt;
+    Stats counters = {};
+
+    void sendInputs();
+    bool handleState(const uint8_t* data, size_t size);
+    bool applyFrame();
+};
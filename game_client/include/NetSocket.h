@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Random.h"
+
+// IPv4 address and port, in host byte order
+struct NetAddress {
+    uint32_t ip = 0;
+    uint16_t port = 0;
+
+    // Resolves host (a name or dotted quad) to its first IPv4 address
+    bool resolve(const std::string& host, uint16_t port);
+    std::string toString() const;
+
+    bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+};
+
+// Simulated network faults, applied to outgoing packets so that loss, delay
+// and reordering can be tested over loopback
+struct LinkConditions {
+    int lossPercent = 0;
+    int delayMs = 0;
+    int jitterMs = 0;       // Each packet's delay varies by up to this much either way
+
+    bool active() const { return lossPercent > 0 || delayMs > 0 || jitterMs > 0; }
+};
+
+// Non-blocking UDP socket. Delayed packets wait in the socket and go out from
+// whichever of send(), receive() or wait() runs after they fall due.
+class UdpSocket {
+public:
+    struct Stats {
+        uint64_t packetsSent;
+        uint64_t bytesSent;
+        uint64_t packetsLost;       // Dropped by the simulated conditions
+        uint64_t packetsReceived;
+        uint64_t bytesReceived;
+    };
+
+    UdpSocket() = default;
+    ~UdpSocket();
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    // Binds to port on every interface; 0 picks a free port
+    bool open(uint16_t port = 0);
+    void close();
+    bool isOpen() const;
+    uint16_t getPort() const { return port; }
+
+    void setConditions(const LinkConditions& conditions, uint64_t seed);
+
+    // False only on a local error; a packet lost to the conditions counts as sent
+    bool send(const NetAddress& to, const void* data, size_t size);
+
+    // Size of the next waiting datagram, or -1 if there is none
+    int receive(NetAddress& from, void* buffer, size_t capacity);
+
+    // Blocks until a datagram arrives, a delayed packet falls due or timeoutMs passes
+    void wait(int timeoutMs);
+
+    const Stats& stats() const { return counters; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Delayed {
+        Clock::time_point due;
+        NetAddress to;
+        std::vector<uint8_t> data;
+    };
+
+    intptr_t handle = -1;
+    uint16_t port = 0;
+    LinkConditions conditions;
+    Xoshiro256 rng{0};
+    std::vector<Delayed> delayed;
+    Stats counters = {};
+
+    bool sendNow(const NetAddress& to, const void* data, size_t size);
+    void flushDelayed();
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-capacity particle pool in structure-of-arrays layout. Integration runs
+// over whole float columns (four particles per SSE instruction where
+// available) and expired particles are removed by moving the last live
+// particle into their slot, so a tick costs O(live particles) no matter how
+// many expire. Positions are in pixels; colours are packed RGBA, one byte per
+// channel with red in the lowest byte.
+class ParticleSystem {
+public:
+    static const size_t DEFAULT_CAPACITY = 131072;
+
+    explicit ParticleSystem(size_t capacity = DEFAULT_CAPACITY);
+
+    // Returns false when the pool is full and the particle was dropped
+    bool emit(float x, float y, float vx, float vy, uint32_t color, int life);
+    void update();
+    void clear() { count = 0; }
+
+    // The two halves of update(); disjoint integrate() ranges may run concurrently
+    void integrate(size_t begin, size_t end);
+    void removeExpired();
+
+    static uint32_t packColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+        return r | (g << 8) | (b << 16) | (static_cast<uint32_t>(a) << 24);
+    }
+
+    // Column access for rendering
+    size_t size() const { return count; }
+    size_t capacity() const { return maxParticles; }
+    const float* xData() const { return xs.data(); }
+    const float* yData() const { return ys.data(); }
+    const float* vxData() const { return vxs.data(); }
+    const float* vyData() const { return vys.data(); }
+    const int32_t* lifeData() const { return lives.data(); }
+    const uint32_t* colorData() const { return colors.data(); }
+
+private:
+    size_t maxParticles;
+    size_t count;
+
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> vxs;
+    std::vector<float> vys;
+    std::vector<int32_t> lives;
+    std::vector<uint32_t> colors;
+};
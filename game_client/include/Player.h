@@ -2,7 +2,9 @@
 class Player {
 public:
     int x,y;
+    int prevX, prevY; // Position at the start of the last tick, for interpolation
+    bool active = true; // False once a networked player has left
     Player(int x, int y);
     void moveLeft();
     void moveRight(int maxWidth);
-};
\ No newline at end of file
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Lightweight frame profiler. PROFILE_ZONE("name") times the enclosing scope
+// into a ring buffer owned by the calling thread; the main thread drains every
+// ring once per frame with endFrame(), feeding the on-screen overlay and,
+// while a trace is open, a Chrome/Perfetto trace file.
+//
+// Zones cost one relaxed atomic load while the profiler is disabled at
+// runtime, and compile to nothing without STAR_DEFENDER_PROFILER.
+namespace profiler {
+
+struct ZoneEvent {
+    const char* name;   // Must outlive the profiler, normally a string literal
+    uint64_t start;     // Nanoseconds since the profiler's epoch
+    uint64_t end;
+};
+
+// Frame-time distribution over the recent history, in milliseconds
+struct FrameSummary {
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    size_t frames;
+};
+
+// Time spent in one zone during the last completed frame
+struct ZoneTotal {
+    const char* name;
+    double milliseconds;
+    int calls;
+};
+
+extern std::atomic<bool> enabledFlag;
+
+inline bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+
+uint64_t now();
+
+// Appends to the calling thread's ring; never blocks or allocates after the
+// thread's first event
+void record(const char* name, uint64_t start, uint64_t end);
+
+// Main-thread API
+void endFrame();
+FrameSummary frameSummary();
+const std::vector<ZoneTotal>& lastFrameZones();
+uint64_t droppedEvents();
+
+// Collects every event from now on and writes them to path on writeTrace()
+void startTrace(const std::string& path);
+bool isTracing();
+bool writeTrace();
+
+class Zone {
+public:
+    explicit Zone(const char* name) : name(isEnabled() ? name : nullptr), start(this->name ? now() : 0) {}
+    ~Zone() {
+        if (name) record(name, start, now());
+    }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+}
+
+#ifdef STAR_DEFENDER_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+// xoshiro256** pseudo-random generator. Small, fast and fully determined by
+// its seed, so each subsystem can own an independent, reproducible stream.
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+
+    // Expands the seed with splitmix64 so that nearby seeds give unrelated streams
+    void reseed(uint64_t seed) {
+        for (uint64_t& word : state) {
+            seed += 0x9e3779b97f4a7c15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [min, max], scaled by multiplication rather than modulo
+    int nextInt(int min, int max) {
+        uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+        return min + static_cast<int>(((next() >> 32) * range) >> 32);
+    }
+
+    const uint64_t* getState() const { return state; }
+    void setState(const uint64_t* words) {
+        for (int i = 0; i < 4; i++) state[i] = words[i];
+    }
+
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
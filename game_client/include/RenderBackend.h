@@ -0,0 +1,14 @@
+#pragma once
+#include "SimSnapshot.h"
+
+// Something that presents simulation snapshots: Game draws them with SDL,
+// TerminalRenderer as text. Backends see only snapshots, never the live
+// Simulation.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    // Draws and presents one frame; alpha blends from the previous tick's
+    // positions (0) to snapshot's (1)
+    virtual void drawFrame(const SimSnapshot& snapshot, float alpha) = 0;
+};
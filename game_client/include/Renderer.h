@@ -2,24 +2,144 @@
 #include <SDL3/SDL.h>
 #include <SDL3_image/SDL_image.h>
 #include <SDL3_ttf/SDL_ttf.h>
+#include <list>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
+#include "FrameArena.h"
 
 class Renderer {
+public:
+    // Registered textures are referenced by index rather than by name
+    using TextureHandle = int;
+    static const TextureHandle INVALID_TEXTURE = -1;
+    
+    // Glyph atlas per font: printable ASCII is rasterized once, in white, into
+    // one texture, and text is drawn as tinted quads from it
+    static const int FIRST_GLYPH = 32;
+    static const int GLYPH_COUNT = 95;
+    struct Glyph {
+        SDL_FRect src;
+        int advance;
+    };
+    
+    // Rasterized glyph atlas pixels, not yet uploaded to a texture
+    struct GlyphSheet {
+        SDL_Surface* surface = nullptr;
+        Glyph glyphs[GLYPH_COUNT] = {};
+    };
+    
+    // Per-frame counters, reset on present()
+    struct FrameStats {
+        int textureUploads = 0;     // Textures created or updated this frame
+        int drawCalls = 0;          // SDL render calls submitted this frame
+        int sprites = 0;            // Quads submitted through the sprite batch
+        int layerRebuilds = 0;      // Cached layers redrawn this frame
+    };
+    
+    // Cached layers are render-target textures that are drawn into only when
+    // their key changes and otherwise composited with one blit
+    using LayerHandle = int;
+    struct LayerStats {
+        std::string name;
+        int rebuilds;               // Since creation
+        int composites;
+    };
+
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
     int screenWidth;
     int screenHeight;
     
-    // Texture cache for loaded images
-    std::unordered_map<std::string, SDL_Texture*> textures;
+    // Registered textures. A handle may cover only a region of its texture,
+    // so several handles can share one atlas.
+    struct TextureEntry {
+        SDL_Texture* texture;
+        int textureId;              // Handle that registered texture; shared by its regions
+        SDL_FRect region;
+        float textureWidth, textureHeight;
+        bool owned;                 // Destroyed by cleanup()
+    };
+    std::vector<TextureEntry> textureTable;
+    std::unordered_map<std::string, TextureHandle> textureNames;
+    
+    // Sprite batch: textured quads are queued and flushed grouped by texture,
+    // one geometry call per texture. Anything drawn immediately (rects,
+    // particles, cached text) flushes the batch first to keep painter's order.
+    struct Sprite {
+        TextureHandle texture;
+        SDL_FRect src;              // In texture pixels
+        SDL_FRect dst;
+        SDL_FColor color;
+    };
+    std::vector<Sprite> spriteBatch;
+    std::vector<uint64_t> spriteOrder;
     
     // Font cache
     std::unordered_map<std::string, TTF_Font*> fonts;
     
+    struct GlyphAtlas {
+        TTF_Font* font = nullptr;
+        TextureHandle texture = INVALID_TEXTURE;
+        Glyph glyphs[GLYPH_COUNT] = {};
+    };
+    std::unordered_map<std::string, GlyphAtlas> glyphAtlases;
+    
+    // LRU cache of whole-string textures for static text, rendered in white
+    // and tinted when drawn
+    static const size_t TEXT_CACHE_CAPACITY = 64;
+    struct CachedText {
+        std::string key;
+        SDL_Texture* texture;
+        float width, height;
+    };
+    std::list<CachedText> textCache;
+    std::unordered_map<std::string, std::list<CachedText>::iterator> textCacheIndex;
+    std::string textCacheKey;   // Reused for lookups, so hits do not allocate
+    
+    // Transient per-frame data, reset by present()
+    static const size_t FRAME_ARENA_SIZE = 64 * 1024;
+    FrameArena frameArena{FRAME_ARENA_SIZE};
+    
+    FrameStats frameStats;
+    FrameStats lastFrameStats;
+    
+    struct Layer {
+        std::string name;
+        SDL_Texture* texture = nullptr;
+        int width, height;
+        uint64_t key = 0;
+        bool valid = false;         // Contents match key
+        int rebuilds = 0;
+        int composites = 0;
+    };
+    std::vector<Layer> layers;
+    LayerHandle activeLayer = -1;
+    
+    // Scratch buffers for batched geometry submission
+    std::vector<SDL_Vertex> geometryVertices;
+    std::vector<int> geometryIndices;
+    
     // Helper function to load a texture
     SDL_Texture* loadTexture(const std::string& path);
+    TextureHandle registerTexture(const std::string& name, SDL_Texture* texture, bool owned);
+    
+    // Sprite batching
+    void queueSprite(TextureHandle texture, const SDL_FRect& src, const SDL_FRect& dst, const SDL_FColor& color);
+    void flushSprites();
+    
+    // Grows the shared index buffer to cover the given number of two-triangle quads
+    void ensureQuadIndices(size_t quads);
+    
+    // Text caching helpers
+    const CachedText* getCachedText(const std::string& fontName, std::string_view text);
+    
+    // Redirects drawing into the layer if it needs rebuilding; false leaves
+    // the target alone
+    bool beginLayer(LayerHandle layer, uint64_t key);
+    void endLayer();
 
 public:
     Renderer(SDL_Window* window, int width, int height);
@@ -34,21 +154,65 @@ public:
     void drawRect(float x, float y, float width, float height);
     void drawFillRect(float x, float y, float width, float height);
     
-    // Texture management
-    bool loadTextureFromFile(const std::string& name, const std::string& path);
-    void drawTexture(const std::string& textureName, float x, float y, float width = -1, float height = -1);
-    void drawTexture(const std::string& textureName, float x, float y, float srcX, float srcY, float srcWidth, float srcHeight, float dstWidth, float dstHeight);
+    // Draws count solid squares with per-square RGBA colours (red in the lowest
+    // byte) in a single geometry call. Square i is centred on
+    // (x[i] + vx[i] * offset, y[i] + vy[i] * offset).
+    void drawParticles(const float* x, const float* y, const float* vx, const float* vy,
+                       const uint32_t* colors, size_t count, float size, float offset);
     
-    // Font management
+    // Texture management. Textures are registered once and drawn by handle;
+    // drawTexture only queues a quad into the sprite batch.
+    TextureHandle loadTextureFromFile(const std::string& name, const std::string& path);
+    TextureHandle getTexture(const std::string& name) const;
+    TextureHandle loadTextureFromSurface(const std::string& name, SDL_Surface* surface);
+    TextureHandle loadTextureFromPixels(const std::string& name, const void* pixels, int width, int height);
+    TextureHandle addTextureRegion(const std::string& name, TextureHandle parent, float x, float y, float width, float height);
+    void drawTexture(TextureHandle texture, float x, float y, float width = -1, float height = -1);
+    void drawTexture(TextureHandle texture, float x, float y, float srcX, float srcY, float srcWidth, float srcHeight, float dstWidth, float dstHeight);
+    
+    // Font management. drawText lays out quads from the font's glyph atlas and
+    // suits text that changes often; drawTextCentered draws a cached texture
+    // of the whole string and suits static menu text.
     bool loadFont(const std::string& name, const std::string& path, int size);
-    void drawText(const std::string& fontName, const std::string& text, float x, float y, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint8 a = 255);
-    void drawTextCentered(const std::string& fontName, const std::string& text, float y, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint8 a = 255);
-    int getTextWidth(const std::string& fontName, const std::string& text);
+    bool loadFontFromMemory(const std::string& name, const void* data, size_t length, int size);
+    
+    // Two-step font loading for background threads: rasterizeGlyphs touches
+    // only the font and may run on any thread; addFont uploads the sheet and
+    // must run on the render thread. addFont takes ownership of both.
+    static GlyphSheet rasterizeGlyphs(TTF_Font* font);
+    bool addFont(const std::string& name, TTF_Font* font, GlyphSheet sheet);
+    bool hasFont(const std::string& name) const { return glyphAtlases.count(name) != 0; }
+    void drawText(const std::string& fontName, std::string_view text, float x, float y, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint8 a = 255);
+    void drawTextCentered(const std::string& fontName, std::string_view text, float y, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint8 a = 255);
+    int getTextWidth(const std::string& fontName, std::string_view text);
+    
+    // Layer caching. updateLayer runs draw with the layer as the render
+    // target, cleared to transparent, only when key differs from the one it
+    // was last drawn with; compositeLayer blits it (or the src part of it)
+    // at x, y. Layers do not nest.
+    LayerHandle createLayer(const std::string& name, int width, int height);
+    template <typename DrawFn>
+    bool updateLayer(LayerHandle layer, uint64_t key, DrawFn&& draw) {
+        if (!beginLayer(layer, key)) return false;
+        draw();
+        endLayer();
+        return true;
+    }
+    void compositeLayer(LayerHandle layer, float x, float y, const SDL_FRect* src = nullptr);
+    
+    // Marks every layer for rebuilding, as after the render targets were lost
+    void invalidateLayers();
+    std::vector<LayerStats> getLayerStats() const;
     
     // Utility functions
     int getWidth() const { return screenWidth; }
     int getHeight() const { return screenHeight; }
     SDL_Renderer* getSDLRenderer() const { return renderer; }
+    const FrameStats& getFrameStats() const { return lastFrameStats; }
+    
+    // Scratch memory for the frame being drawn, such as formatted text;
+    // released by present()
+    FrameArena& getFrameArena() { return frameArena; }
     
     // Cleanup
     void cleanup();
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ThreadPool.h"
+
+class Simulation;
+
+// Server-side check of submitted scores. Each claim's input log is replayed
+// from its seed as fast as the CPU allows, and the claim is accepted only if
+// the log is a complete recording on the ranked field whose state hashes all
+// match and which ends on the claimed score. Game rules use integers only
+// (particle positions are floats, but never reach the state hash), so
+// verdicts are the same whatever the compiler or optimisation level;
+// recordings hash little-endian memory.
+struct VerifyConfig {
+    int width = 800;                    // The field scores are ranked on
+    int height = 600;
+    uint64_t maxUpdates = 12 * 60 * 60 * 4; // Four hours of play
+    unsigned threads = 0;               // Zero: one per hardware thread
+};
+
+// One submitted score with the recording it claims to come from
+struct VerifyClaim {
+    uint64_t seed;
+    int score;
+    std::vector<uint8_t> log;           // A whole recording, as InputRecorder writes it
+};
+
+class ReplayVerifier {
+public:
+    enum class Verdict : uint8_t {
+        ACCEPTED,
+        MALFORMED,      // Not a recording, unknown records, or no end marker
+        WRONG_SEED,     // The recording was made with another seed
+        WRONG_FIELD,    // The recording was made on another field size
+        TOO_LONG,       // More than maxUpdates of play
+        HASH_MISMATCH,  // The game went differently than when it was recorded
+        SCORE_MISMATCH  // The game ends on another score
+    };
+
+    struct Result {
+        Verdict verdict;
+        int score;          // Replayed, as far as the replay got
+        uint64_t updates;
+    };
+
+    explicit ReplayVerifier(const VerifyConfig& config = VerifyConfig());
+    ~ReplayVerifier();
+    ReplayVerifier(const ReplayVerifier&) = delete;
+    ReplayVerifier& operator=(const ReplayVerifier&) = delete;
+
+    // Verifies a batch across the threads, the caller's included; results[i]
+    // is for claims[i]. Threads and simulations are kept between batches.
+    void verify(const std::vector<VerifyClaim>& claims, std::vector<Result>& results);
+
+    // Verifies one claim on the calling thread
+    Result verifyOne(const VerifyClaim& claim);
+
+    unsigned getThreads() const { return threadCount; }
+    static const char* verdictName(Verdict verdict);
+
+private:
+    VerifyConfig config;
+    unsigned threadCount;
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<std::unique_ptr<Simulation>> sims;  // One per thread, restarted per claim
+
+    Result verifyWith(const VerifyClaim& claim, Simulation& sim) const;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Simulation.h"
+
+// Copy of everything the renderer needs from one simulation step, so that
+// rendering never touches the live Simulation. Buffers keep their capacity
+// between captures, so steady-state captures do not allocate.
+struct SimSnapshot {
+    struct Entities {
+        std::vector<int16_t> x;
+        std::vector<int16_t> y;
+        std::vector<int16_t> prevX;
+        std::vector<int16_t> prevY;
+
+        size_t size() const { return x.size(); }
+        void capture(const EntityStore& store);
+    };
+
+    struct Particles {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> vx;
+        std::vector<float> vy;
+        std::vector<uint32_t> color;
+
+        size_t size() const { return x.size(); }
+        void capture(const ParticleSystem& particles);
+    };
+
+    Simulation::GameState state = Simulation::MENU;
+    int score = 0;
+    int tick = 0;
+    int playerX = 0;        // The local player's ship
+    int playerY = 0;
+    Entities others;        // Every other active player's ship
+    Entities enemies;
+    Entities bullets;
+    Particles particles;
+
+    // steady_clock time in nanoseconds at which the latest update was due;
+    // the renderer interpolates forward from it
+    int64_t updateTime = 0;
+
+    // Actions from SimulationThread::pushAction applied before the capture
+    uint32_t actionsApplied = 0;
+
+    // Set when the simulation thread has stopped ticking until the next
+    // action: nothing in a non-playing state changes between inputs
+    bool settled = false;
+
+    void capture(const Simulation& sim, int localPlayer = 0);
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "Player.h"
+#include "EntityStore.h"
+#include "CollisionGrid.h"
+#include "ParticleSystem.h"
+#include "JobSystem.h"
+#include "Random.h"
+
+class SnapshotView;
+
+// Game rules and world state. Has no dependency on SDL video, a window or a
+// renderer, so it can be stepped headless as fast as the CPU allows.
+class Simulation {
+public:
+    // Game state
+    enum GameState {
+        MENU,
+        PLAYING,
+        GAME_OVER,
+        PAUSED
+    };
+
+    // Player commands, one per key role; their meaning depends on the state
+    enum class Action : uint8_t {
+        FIRE,       // SPACE: shoot, or start/leave the game from a menu screen
+        CONFIRM,    // ENTER: start/leave the game from a menu screen
+        PAUSE,      // ESC: pause or resume
+        MOVE_LEFT,
+        MOVE_RIGHT
+    };
+
+    // Bullet/enemy collision engine
+    enum class CollisionMode : uint8_t {
+        NESTED_LOOP,    // Compare every bullet with every enemy
+        BITBOARD        // Intersect per-row occupancy bitmasks
+    };
+
+    // Coordinate conversion
+    static const int TILE_SIZE = 48; // Each game tile is 48x48 pixels
+
+    // Fixed simulation rate, independent of the display refresh rate
+    static const int TICKS_PER_SECOND = 12; // 12 Hz for retro feel
+
+    // Player 0 is the local player; co-op adds the others
+    static const int MAX_PLAYERS = 4;
+
+    // Identical seeds and identical action sequences give identical games
+    Simulation(int width, int height, uint64_t seed);
+
+    void update();
+    void reset();
+
+    // Back to the menu with a new seed, as a newly constructed Simulation
+    // of the same size, but keeping the allocated pools and the settings
+    // below. Construction zeroes the whole particle pool, which costs more
+    // than playing a short game, so tools that play many games restart one
+    // Simulation per thread instead.
+    void restart(uint64_t newSeed);
+    void applyAction(Action action, int player = 0);
+    void setGameState(GameState newState);
+    void setCollisionMode(CollisionMode mode) { collisionMode = mode; }
+
+    // Runs the per-entity passes of large worlds on jobs; null runs them
+    // serially. Results are identical either way.
+    void setJobSystem(JobSystem* jobSystem) { jobs = jobSystem; }
+
+    // Co-op players. addPlayer() returns the new index, or -1 when full;
+    // a removed player's slot stays inactive so indices remain stable.
+    int addPlayer();
+    void removePlayer(int index);
+
+    // Direct spawning for load generation and tools, outside the spawn schedule
+    void spawnEnemy(int x, int y) { enemies.spawn(x, y); }
+    void spawnBullet(int x, int y) { bullets.spawn(x, y); }
+
+    // Load generation knobs: breaching enemies are removed without ending
+    // the game, and every hit emits scale times the normal particles
+    void setEndless(bool value) { endless = value; }
+    void setEffectScale(int scale) { effectScale = scale; }
+
+    // State access
+    GameState getGameState() const { return currentState; }
+    const Player& getPlayer(int index = 0) const { return players[index]; }
+    int getPlayerCount() const { return static_cast<int>(players.size()); }
+    const EntityStore& getEnemies() const { return enemies; }
+    const EntityStore& getBullets() const { return bullets; }
+    const ParticleSystem& getParticles() const { return particles; }
+    uint64_t getSeed() const { return seed; }
+    int getTick() const { return tick; }
+    int getScore() const { return score; }
+    int getEnemiesSpawned() const { return enemiesSpawned; }
+    float getDifficulty() const { return difficulty; }
+    const Xoshiro256& getSpawnRng() const { return spawnRng; }
+    const Xoshiro256& getEffectsRng() const { return effectsRng; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getColumns() const { return width / TILE_SIZE; }
+    int getRows() const { return height / TILE_SIZE; }
+
+    // Digest of the gameplay state, for checking that a replay stays in step
+    uint64_t stateHash() const;
+
+    // Replaces the gameplay state with an encoded snapshot's; fails if the
+    // snapshot is of a different world size. Particles are not part of
+    // snapshots, so they are dropped unless keepParticles is set.
+    bool restore(const SnapshotView& snapshot, bool keepParticles = false);
+
+    // Hits resolved by the last update(), as enemy grid positions
+    const std::vector<std::pair<int16_t, int16_t>>& getTickHits() const { return tickHits; }
+
+    // Effects only, for worlds mirrored from elsewhere: emits a hit's
+    // particles, or advances the particles by one tick
+    void emitHitEffect(int x, int y) { createHitEffect(x, y); }
+    void updateEffects();
+
+    // Helper functions for coordinate conversion
+    static float gameToPixelX(int gameX) { return gameX * TILE_SIZE; }
+    static float gameToPixelY(int gameY) { return gameY * TILE_SIZE; }
+    static int pixelToGameX(float pixelX) { return static_cast<int>(pixelX / TILE_SIZE); }
+    static int pixelToGameY(float pixelY) { return static_cast<int>(pixelY / TILE_SIZE); }
+
+private:
+    int width;
+    int height;
+    int tick;
+    int score;
+    float difficulty;
+    int enemiesSpawned;
+    GameState currentState;
+
+    // Game entities
+    static constexpr size_t ENTITY_POOL_CAPACITY = 4096;
+    std::vector<Player> players;
+    EntityStore enemies;
+    EntityStore bullets;
+
+    // Particle system for visual effects
+    ParticleSystem particles;
+
+    // One generator per subsystem, so effects never shift gameplay randomness
+    static const uint64_t EFFECTS_STREAM = 0x5eed0e77ec75ull;
+    uint64_t seed;
+    Xoshiro256 spawnRng;
+    Xoshiro256 effectsRng;
+
+    // Collision detection
+    CollisionMode collisionMode;
+    CollisionGrid collisionGrid;
+    std::vector<Hit> hits;
+    std::vector<std::pair<int16_t, int16_t>> tickHits;
+    std::vector<std::vector<Hit>> chunkHits; // Per parallel chunk, merged in chunk order
+
+    // Passes over fewer entities than the threshold stay serial; chunks are
+    // a multiple of 64 so that concurrent kills never share a liveness word
+    static const size_t PARALLEL_THRESHOLD = 16384;
+    static const size_t PARALLEL_GRAIN = 4096;
+    JobSystem* jobs = nullptr;
+
+    bool endless = false;
+    int effectScale = 1;
+
+    template <typename F>
+    void forEachRange(size_t count, F&& fn) {
+        if (jobs && count >= PARALLEL_THRESHOLD) {
+            jobs->parallelFor(count, PARALLEL_GRAIN, fn);
+        } else {
+            fn(size_t(0), count);
+        }
+    }
+
+    void spawnEnemies();
+    void savePreviousPositions();
+
+    // Enhanced collision detection
+    void resolveCollisions();
+    void removeOffScreenBullets();
+    void removeBreachingEnemies();
+    void createHitEffect(int x, int y);
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <semaphore>
+#include <thread>
+#include "InputRecording.h"
+#include "SimSnapshot.h"
+#include "Simulation.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+// Runs the fixed-rate simulation on its own thread. Actions arrive from the
+// input thread over a lock-free queue and wake the thread at once, so they
+// are applied without waiting for the next tick; every change is published
+// as a SimSnapshot through a triple buffer for the render thread. Outside
+// play the thread stops ticking after one tick and sleeps until the next
+// action, marking the snapshot settled.
+class SimulationThread {
+public:
+    // sim and recorder belong to the thread between start() and stop()
+    SimulationThread(Simulation& sim, InputRecorder& recorder);
+    ~SimulationThread();
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void start();
+    void stop();
+
+    // Input thread; false if the queue is full and the action was dropped
+    bool pushAction(Simulation::Action action);
+
+    // Render thread; the newest snapshot, valid until the next call
+    const SimSnapshot& latest() { return snapshots.read(); }
+
+    // Render thread; as latest(), but first waits up to timeout for a
+    // snapshot with at least actions of the pushed actions applied
+    const SimSnapshot& latest(uint32_t actions, std::chrono::microseconds timeout);
+
+    // Times the thread has woken, for ticks, actions or network polls
+    uint64_t getWakeups() const { return wakeupCount.load(std::memory_order_relaxed); }
+
+    // Called on the simulation thread whenever a game ends; set before start()
+    void setGameOverHandler(std::function<void(const Simulation&)> handler) { onGameOver = std::move(handler); }
+
+    // Network hooks, run on the simulation thread; set before start(). poll
+    // runs whenever the thread wakes, at least every pollInterval, and
+    // returns whether it changed the simulation; afterUpdate runs after
+    // every tick.
+    void setNetworkHandlers(std::function<bool(Simulation&)> poll, std::function<void(const Simulation&)> afterUpdate,
+                            std::chrono::milliseconds pollInterval) {
+        onPoll = std::move(poll);
+        onUpdate = std::move(afterUpdate);
+        this->pollInterval = pollInterval;
+    }
+
+private:
+    static const size_t ACTION_QUEUE_SIZE = 256;
+
+    Simulation& sim;
+    InputRecorder& recorder;
+    SpscQueue<Simulation::Action, ACTION_QUEUE_SIZE> actions;
+    TripleBuffer<SimSnapshot> snapshots;
+    std::function<void(const Simulation&)> onGameOver;
+    std::function<bool(Simulation&)> onPoll;
+    std::function<void(const Simulation&)> onUpdate;
+    std::chrono::milliseconds pollInterval{0};
+    uint32_t actionsApplied = 0;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::counting_semaphore<> wake{0};
+    std::atomic<bool> wakePending{false};
+    std::atomic<uint64_t> wakeupCount{0};
+
+    void loop();
+    bool applyPendingActions();
+    void publish(int64_t updateTime, bool settled);
+};
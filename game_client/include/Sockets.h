@@ -0,0 +1,62 @@
+#pragma once
+// BSD sockets and Winsock differ in a handful of calls; this covers the ones
+// the HTTP and UDP code use. Include only from .cpp files, since the system
+// headers bring in a lot.
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace sockets {
+
+#ifdef _WIN32
+using Socket = SOCKET;
+const Socket NO_SOCKET = INVALID_SOCKET;
+
+inline void closeSocket(Socket s) { closesocket(s); }
+inline bool setNonBlocking(Socket s) {
+    u_long mode = 1;
+    return ioctlsocket(s, FIONBIO, &mode) == 0;
+}
+inline bool connectPending() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+inline bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+inline int pollSockets(pollfd* entries, unsigned long count, int timeoutMs) { return WSAPoll(entries, count, timeoutMs); }
+inline bool startNetworking() {
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+#else
+using Socket = int;
+const Socket NO_SOCKET = -1;
+
+inline void closeSocket(Socket s) { ::close(s); }
+inline bool setNonBlocking(Socket s) {
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+inline bool connectPending() { return errno == EINPROGRESS; }
+inline bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+inline int pollSockets(pollfd* entries, nfds_t count, int timeoutMs) { return ::poll(entries, count, timeoutMs); }
+inline bool startNetworking() { return true; }
+#endif
+
+#if defined(MSG_NOSIGNAL)
+const int SEND_FLAGS = MSG_NOSIGNAL; // A dropped connection must not raise SIGPIPE
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Indices grow without wrapping and are masked on access; each sits
+// on its own cache line so the two sides do not contend.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side; fails when the queue is full
+    bool push(const T& value) {
+        size_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == Capacity) return false;
+        items[write & (Capacity - 1)] = value;
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves value in, so buffers change hands without being copied
+    bool push(T&& value) {
+        size_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == Capacity) return false;
+        items[write & (Capacity - 1)] = std::move(value);
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; fails when the queue is empty
+    bool pop(T& value) {
+        size_t read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire)) return false;
+        value = std::move(items[read & (Capacity - 1)]);
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> readIndex{0};
+    alignas(64) std::atomic<size_t> writeIndex{0};
+    T items[Capacity];
+};
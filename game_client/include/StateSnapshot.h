@@ -0,0 +1,97 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Simulation;
+
+// Versioned binary image of the gameplay state: tick, score, difficulty,
+// spawn count, players, enemies, bullets and both generators. Particles are
+// cosmetic and left out.
+//
+// Full layout: SnapshotHeader, then int16 columns grouped enemies, bullets,
+// players, each group holding x, y, prevX and prevY. The previous positions
+// let a mirrored world interpolate exactly like the source. An inactive
+// player has x = -1. All fields are fixed-width little-endian and naturally
+// aligned, so SnapshotView reads an 8-byte aligned buffer in place.
+//
+// Delta layout: DeltaHeader, then the header words as varints (zigzag
+// differences for the 32-bit fields, XOR for the 64-bit ones), then for each
+// column its count and runs of (varint length, zigzag varint difference).
+// Positions are differenced against the base column and previous positions
+// against the target's own positions. Entities keep their order between
+// ticks apart from swap-and-pop removals, so a tick's columns mostly
+// collapse to a few runs.
+namespace snapshot {
+
+static_assert(std::endian::native == std::endian::little, "snapshots are stored in host byte order");
+
+const char MAGIC[4] = {'S', 'D', 'S', 'S'};
+const char DELTA_MAGIC[4] = {'S', 'D', 'S', 'D'};
+const uint16_t VERSION = 2;
+
+enum Group { ENEMIES, BULLETS, PLAYERS, GROUPS };
+enum Field { X, Y, PREV_X, PREV_Y, FIELDS };
+
+struct SnapshotHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    int32_t width;
+    int32_t height;
+    int32_t state;
+    int32_t tick;
+    int32_t score;
+    int32_t enemiesSpawned;
+    float difficulty;
+    uint32_t counts[GROUPS];
+    uint64_t seed;
+    uint64_t spawnRng[4];
+    uint64_t effectsRng[4];
+};
+static_assert(sizeof(SnapshotHeader) == 120);
+
+struct DeltaHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    int32_t baseTick;       // Tick and size of the snapshot the delta applies to
+    uint32_t baseSize;
+    uint32_t size;          // Size of the full snapshot it rebuilds
+};
+static_assert(sizeof(DeltaHeader) == 20);
+
+}
+
+// Read-only view of an encoded full snapshot; nothing is copied, so the
+// buffer must outlive the view
+class SnapshotView {
+public:
+    // Checks magic, version, alignment and that the columns fit in size
+    bool open(const uint8_t* data, size_t size);
+
+    const snapshot::SnapshotHeader& header() const { return *head; }
+    size_t size() const { return bytes; }
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(head); }
+
+    uint32_t count(snapshot::Group group) const { return head->counts[group]; }
+    const int16_t* column(snapshot::Group group, snapshot::Field field) const {
+        return columns + groupOffset[group] + field * head->counts[group];
+    }
+
+private:
+    const snapshot::SnapshotHeader* head = nullptr;
+    const int16_t* columns = nullptr;
+    size_t groupOffset[snapshot::GROUPS] = {};
+    size_t bytes = 0;
+};
+
+// Encoders overwrite out; a reused buffer keeps its capacity, so
+// steady-state encoding does not allocate
+void encodeSnapshot(const Simulation& sim, std::vector<uint8_t>& out);
+void encodeDelta(const SnapshotView& base, const SnapshotView& target, std::vector<uint8_t>& out);
+
+// Rebuilds the full snapshot that a delta was encoded from. Fails on a
+// malformed delta or one made against a different base.
+bool applyDelta(const SnapshotView& base, const uint8_t* delta, size_t size, std::vector<uint8_t>& out);
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include "Random.h"
+#include "RenderBackend.h"
+#include "SimSnapshot.h"
+#include "Simulation.h"
+
+// Load generator for capacity testing. Spawns enemies along the top row and
+// fires bullets upward from the bottom in a sweeping pattern over every other
+// column, multiplying
+// both rates every rampTicks ticks. Each ramp step is one measurement
+// window: the entity counts at the end of the last window whose average cost
+// stayed within budget are the sustained capacity. Simulation and rendering
+// costs are judged separately.
+struct StressConfig {
+    int columns = 64;
+    int rows = 48;
+    double spawnRate = 1.0;         // Enemies per tick at the start
+    double fireRate = 4.0;          // Bullets per tick at the start
+    int particleMultiplier = 1;     // Particles per hit, relative to normal play
+    double rampFactor = 1.25;
+    int rampTicks = 60;
+    double budgetMs = 16.7;         // Per tick for simulation, per frame for rendering
+    long maxTicks = 100000;
+    uint64_t seed = 1;
+};
+
+class StressTest {
+public:
+    struct Capacity {
+        bool measured = false;
+        size_t enemies = 0;
+        size_t bullets = 0;
+        size_t particles = 0;
+        double averageMs = 0;
+
+        size_t total() const { return enemies + bullets + particles; }
+    };
+
+    explicit StressTest(const StressConfig& config);
+
+    Simulation& getSimulation() { return sim; }
+    const StressConfig& getConfig() const { return config; }
+
+    // Spawns this tick's load and advances the simulation; returns its cost in milliseconds
+    double tick();
+
+    // Draws the world after the latest tick with backend, counting the time
+    // taken as the render cost
+    void render(RenderBackend& backend);
+
+    // Reports the cost of drawing the world after the latest tick
+    void addRenderTime(double milliseconds);
+
+    // True once every measured cost has gone over budget, or at maxTicks
+    bool finished() const;
+
+    const Capacity& getSimulationCapacity() const { return simulationCapacity; }
+    const Capacity& getRenderCapacity() const { return renderCapacity; }
+    void report(std::ostream& out) const;
+
+private:
+    struct Window {
+        double totalMs = 0;
+        int samples = 0;
+        bool overBudget = false;
+    };
+
+    StressConfig config;
+    Simulation sim;
+    Xoshiro256 rng;
+    SimSnapshot snapshot;
+
+    double spawnRate;
+    double fireRate;
+    double spawnCarry = 0;
+    double fireCarry = 0;
+    int sweep = 0;
+    long ticks = 0;
+
+    Window simulationWindow;
+    Window renderWindow;
+    bool renderMeasured = false;
+    Capacity simulationCapacity;
+    Capacity renderCapacity;
+
+    void spawnLoad();
+    void closeWindow(Window& window, Capacity& capacity);
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "Simulation.h"
+#include "SimulationThread.h"
+#include "TerminalRenderer.h"
+
+// The game in a terminal, without SDL: the simulation runs on its own thread
+// as in the windowed game, keys are read from stdin in raw mode and frames
+// are drawn to stdout with TerminalRenderer whenever the state changes.
+// Terminals report key presses and repeats but not releases, so movement
+// follows the terminal's key repeat.
+class TerminalGame {
+public:
+    TerminalGame(int width, int height, uint64_t seed, JobSystem* jobs);
+    ~TerminalGame();
+    TerminalGame(const TerminalGame&) = delete;
+    TerminalGame& operator=(const TerminalGame&) = delete;
+
+    // Logs the seed and every action from now on; call before run()
+    bool startRecording(const std::string& path);
+
+    // Plays until Q, Ctrl-C or end of input; false if stdin or stdout is
+    // not a terminal
+    bool run();
+
+    const TerminalRenderer::Stats& outputStats() const { return renderer.stats(); }
+
+private:
+    Simulation sim;
+    InputRecorder recorder;
+    SimulationThread simThread;
+    TerminalRenderer renderer;
+    uint32_t actionsPushed = 0;
+
+    // Turns the keys read into actions; false once the player quits
+    bool handleKeys(const char* keys, int count);
+    void applyAction(Simulation::Action action);
+};
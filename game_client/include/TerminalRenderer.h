@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RenderBackend.h"
+
+// Draws the tile grid as text, for terminals over SSH or without a display.
+// Each tile is two character cells inside a border, with the score above and
+// prompts below. A frame is composed into a cell buffer and compared with
+// what the terminal already shows; only changed cells are sent, as cursor
+// moves and runs of text with ANSI colours, in a single write() per frame.
+// Entities sit on whole tiles, so alpha is ignored.
+class TerminalRenderer : public RenderBackend {
+public:
+    struct Stats {
+        uint64_t frames;
+        uint64_t bytes;             // Written over all frames
+        uint64_t firstFrameBytes;   // The full redraw
+        uint64_t lastFrameBytes;
+        uint64_t maxFrameBytes;     // After the first frame
+        uint64_t cellsChanged;      // Over all frames
+    };
+
+    // Output goes to fd; a negative fd composes and counts but writes nothing
+    TerminalRenderer(int columns, int rows, int fd);
+    ~TerminalRenderer() override;
+    TerminalRenderer(const TerminalRenderer&) = delete;
+    TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+    void drawFrame(const SimSnapshot& snapshot, float alpha) override;
+
+    // Redraws every cell on the next frame, as after the screen was cleared
+    void invalidate() { fullRedraw = true; }
+
+    // Leaves the alternate screen and shows the cursor again; the next frame
+    // starts over. Also done on destruction.
+    void restoreScreen();
+
+    // Size in character cells
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const Stats& stats() const { return counters; }
+
+private:
+    enum Color : uint8_t {
+        DEFAULT,
+        RED,
+        GREEN,
+        YELLOW,
+        BLUE,
+        CYAN,
+        WHITE,
+        COLOR_COUNT
+    };
+
+    struct Cell {
+        char ch;
+        Color color;
+
+        bool operator==(const Cell& other) const { return ch == other.ch && color == other.color; }
+    };
+
+    int columns;
+    int rows;
+    int width;
+    int height;
+    int fd;
+
+    std::vector<Cell> back;     // Frame being composed
+    std::vector<Cell> front;    // What the terminal shows
+    std::string out;            // Escape sequences for one frame; keeps its capacity
+    bool started = false;
+    bool fullRedraw = true;
+
+    // Terminal state as left by the output so far; -1 when unknown
+    int cursorRow = -1;
+    int cursorColumn = -1;
+    int currentColor = -1;
+
+    Stats counters = {};
+
+    void compose(const SimSnapshot& snapshot);
+    void put(int row, int column, char ch, Color color);
+    void putText(int row, int column, const char* text, Color color);
+    void putCentered(int row, const char* text, Color color);
+    void putTile(int x, int y, const char* glyph, Color color);
+
+    void emitChanges();
+    void moveTo(int row, int column);
+    void setColor(Color color);
+    size_t moveCost(int row, int column) const;
+    size_t colorCost(Color color, int from) const;
+    void flush();
+};
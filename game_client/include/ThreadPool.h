@@ -0,0 +1,48 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a shared FIFO of tasks
+class ThreadPool {
+public:
+    // Zero picks one worker per hardware thread, minus one for the caller
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queues task and returns a future for its result
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())>;
+
+    size_t size() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+template <typename F>
+auto ThreadPool::submit(F task) -> std::future<decltype(task())> {
+    using Result = decltype(task());
+    // packaged_task is move-only and std::function needs a copyable target
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = packaged->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push([packaged] { (*packaged)(); });
+    }
+    available.notify_one();
+    return result;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-over of the latest value from one writer thread to one
+// reader thread. The writer fills its private back buffer and publishes it
+// by swapping it with the shared middle slot; the reader swaps the middle
+// slot for its front buffer when something new has been published. Neither
+// side ever waits, and the reader always sees a complete value.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& writeBuffer() { return buffers[back]; }
+    void publish() {
+        uint8_t previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // Reader side; returns the newest published value
+    const T& read() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & INDEX_MASK;
+        }
+        return buffers[front];
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH = 0x4;
+
+    T buffers[3];
+    uint8_t back = 0;                   // Writer only
+    std::atomic<uint8_t> middle{1};
+    uint8_t front = 2;                  // Reader only
+};
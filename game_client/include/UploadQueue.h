@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HttpClient.h"
+#include "SpscQueue.h"
+#include "WriteAheadLog.h"
+
+struct UploadConfig {
+    std::string url;                // http://host[:port]/path of the batch endpoint
+    std::string logPath;            // Write-ahead log; pending uploads survive restarts here
+    size_t maxBatchRecords = 64;
+    size_t maxBatchBytes = 1 << 20;
+    int batchDelayMs = 1000;        // How long to gather records before sending
+    int initialBackoffMs = 500;     // Doubles after every failed attempt...
+    int maxBackoffMs = 60000;       // ...up to this
+    int timeoutMs = 3000;           // Per request
+};
+
+// Background upload of game results and state snapshots. The producer only
+// moves a record into a lock-free queue; a worker thread appends it to the
+// write-ahead log, batches and compresses pending records, and POSTs them
+// with exponential backoff while the backend is unreachable. Records are
+// only dropped from the log once the server has accepted them.
+//
+// Batch body: BatchHeader, then per record a BatchRecord and its payload;
+// gzip-encoded when zlib is available.
+namespace upload {
+
+const char MAGIC[4] = {'S', 'D', 'U', 'P'};
+const uint32_t VERSION = 1;
+
+enum RecordType : uint8_t {
+    RECORD_SCORE = 1,       // ScoreRecord
+    RECORD_SNAPSHOT = 2     // Encoded state snapshot
+};
+
+struct ScoreRecord {
+    int32_t score;
+    int32_t tick;
+    uint64_t seed;
+    int64_t finishedAt;     // Unix time in seconds
+};
+
+#pragma pack(push, 1)
+struct BatchHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t clientId;
+    uint32_t count;
+};
+
+struct BatchRecord {
+    uint8_t type;
+    uint64_t sequence;
+    uint32_t length;
+};
+#pragma pack(pop)
+
+}
+
+class UploadQueue {
+public:
+    struct Stats {
+        uint64_t submitted;     // Accepted from the producer
+        uint64_t dropped;       // Rejected because the queue was full
+        uint64_t uploaded;      // Accepted by the server
+        uint64_t rejected;      // Refused by the server as invalid and discarded
+        uint64_t failedAttempts;
+        uint64_t pending;       // In the log awaiting upload
+    };
+
+    explicit UploadQueue(const UploadConfig& config);
+    ~UploadQueue();
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+
+    // Opens the log, picking up anything a previous run left, and starts
+    // the worker
+    bool start();
+
+    // Logs whatever has been submitted and stops the worker; records not yet
+    // uploaded are sent on the next start(). Waits for at most one request
+    // already in flight.
+    void stop();
+
+    // Producer thread only. Lock-free; false if the queue was full.
+    bool submitScore(const upload::ScoreRecord& score);
+    bool submitSnapshot(std::vector<uint8_t>&& snapshot);
+
+    Stats stats() const;
+
+private:
+    struct Record {
+        upload::RecordType type;
+        std::vector<uint8_t> payload;
+    };
+    static const size_t QUEUE_SIZE = 256;
+
+    UploadConfig config;
+    HttpUrl url;
+    WriteAheadLog log;
+    SpscQueue<Record, QUEUE_SIZE> queue;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::counting_semaphore<> wake{0};
+    std::atomic<bool> wakePending{false};
+
+    // Worker state
+    std::vector<WriteAheadLog::Entry> pending;
+    std::vector<uint8_t> body;
+    std::vector<uint8_t> compressed;
+    int retryAfterMs = -1;      // Server-requested delay before the next attempt
+
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> uploaded{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> failedAttempts{0};
+    std::atomic<uint64_t> pendingCount{0};
+
+    bool submit(Record&& record);
+    void loop();
+    void drainQueue();
+    bool sendBatch();
+    void sleepFor(std::chrono::milliseconds duration);
+};
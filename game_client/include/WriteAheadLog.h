@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Append-only log of records waiting to be uploaded. Every record carries a
+// checksum, so a write torn by a crash is detected on the next open and cut
+// off; everything before it survives. Uploads are acknowledged with a
+// watermark record, and the log is rewritten without acknowledged records
+// once they make up most of it.
+//
+// Layout: entries of EntryHeader then payload. The first entry is a
+// TYPE_CLIENT record holding an 8-byte random client id, so the server can
+// drop duplicates of (client, sequence) after a retry.
+namespace wal {
+
+const uint8_t TYPE_CLIENT = 0xfe;
+const uint8_t TYPE_ACK = 0xff;  // Sequence is the highest acknowledged record
+
+struct EntryHeader {
+    uint32_t length;    // Payload bytes
+    uint32_t checksum;  // CRC-32 of the rest of the header and the payload
+    uint64_t sequence;
+    uint8_t type;
+    uint8_t reserved[7];
+};
+static_assert(sizeof(EntryHeader) == 24);
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+}
+
+class WriteAheadLog {
+public:
+    struct Entry {
+        uint64_t sequence;
+        uint8_t type;
+        std::vector<uint8_t> payload;
+    };
+
+    WriteAheadLog() = default;
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Opens or creates the log and returns its unacknowledged records in order
+    bool open(const std::string& path, std::vector<Entry>& pending);
+    void close();
+
+    // Records are durable once sync() returns true. A failed write or sync
+    // cuts the file back to the last sync, so sync() then returns false for
+    // the records appended since; if that fails too, the log takes no more.
+    uint64_t append(uint8_t type, const uint8_t* data, size_t size);
+    bool sync();
+
+    // Marks every record up to sequence as uploaded; pending must hold the
+    // records still unacknowledged afterwards, for compaction
+    bool acknowledge(uint64_t sequence, const std::vector<Entry>& pending);
+
+    uint64_t getClientId() const { return clientId; }
+    uint64_t getSize() const { return size; }
+
+private:
+    static const uint64_t COMPACT_SIZE = 1 << 20;
+
+    std::string path;
+    std::FILE* file = nullptr;
+    uint64_t clientId = 0;
+    uint64_t nextSequence = 1;
+    uint64_t size = 0;
+    uint64_t syncedSize = 0;    // Size at the last successful sync
+    bool recordsLost = false;   // A rollback cut records appended since then
+
+    bool writeEntry(std::FILE* out, uint64_t sequence, uint8_t type, const uint8_t* data, size_t length);
+    void rollback();
+    bool compact(uint64_t acknowledged, const std::vector<Entry>& pending);
+};
@@ -0,0 +1,82 @@
+#include "../include/AllocationCounter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions. Every form of operator new ends
+// up in allocate(); the array and nothrow forms of delete forward to the
+// plain ones by default. The sized forms are replaced too, as a library may
+// provide its own that would bypass release().
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+
+void* allocate(std::size_t size, std::size_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void release(void* pointer, std::size_t alignment) {
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(pointer);
+        return;
+    }
+#endif
+    (void)alignment;
+    std::free(pointer);
+}
+
+}
+
+namespace allocations {
+
+uint64_t count() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+}
+
+void* operator new(std::size_t size) {
+    void* pointer = allocate(size, alignof(std::max_align_t));
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = allocate(size, static_cast<std::size_t>(alignment));
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    release(pointer, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    release(pointer, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<std::size_t>(alignment));
+}
@@ -0,0 +1,148 @@
+#include "../include/AssetLoader.h"
+#include "../include/Profiler.h"
+#include <SDL3_image/SDL_image.h>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+template <typename T>
+bool isReady(const std::future<T>& future) {
+    return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+}
+
+AssetLoader::AssetLoader(Renderer* renderer)
+    : renderer(renderer), pool(2),
+      fontsDone(fontsPromise.get_future().share()), texturesDone(texturesPromise.get_future().share()) {}
+
+AssetLoader::~AssetLoader() {
+    shutdown();
+}
+
+void AssetLoader::start(const std::string& basePath, const std::vector<FontRequest>& fonts,
+                        const std::vector<TextureRequest>& textures) {
+    started = true;
+    bool packed = assetPack.open(basePath + "star_defender.pack");
+    std::string assets = basePath + "../assets/";
+    fontItems = static_cast<int>(fonts.size());
+    totalItems = static_cast<int>(fonts.size() + textures.size());
+
+    // FreeType shares one library object between fonts, so fonts are opened
+    // one after another in a single job rather than in parallel
+    pendingFonts = pool.submit([this, fonts, packed, assets] {
+        PROFILE_ZONE("loadFonts");
+        std::vector<LoadedFont> loaded;
+        for (const auto& request : fonts) {
+            TTF_Font* font = nullptr;
+            if (packed) {
+                const pack::PackEntry* entry = assetPack.find("font:" + request.file);
+                if (entry) font = TTF_OpenFontIO(SDL_IOFromConstMem(assetPack.data(*entry), entry->size), true, request.size);
+            } else {
+                font = TTF_OpenFont((assets + request.file).c_str(), request.size);
+            }
+            if (!font) {
+                std::cerr << "Error loading font " << request.file << ": " << SDL_GetError() << std::endl;
+                continue;
+            }
+            loaded.push_back({request.name, font, Renderer::rasterizeGlyphs(font)});
+        }
+        return loaded;
+    });
+
+    if (packed) {
+        // Already decoded; only the upload is left, done on the first poll
+        packedTextures = textures;
+        return;
+    }
+    for (const auto& request : textures) {
+        pendingImages.push_back(pool.submit([request, assets] {
+            PROFILE_ZONE("loadImage");
+            SDL_Surface* surface = IMG_Load((assets + request.file).c_str());
+            if (!surface) {
+                std::cerr << "Error loading image " << request.file << ": " << SDL_GetError() << std::endl;
+            }
+            return LoadedImage{request.name, surface};
+        }));
+    }
+}
+
+void AssetLoader::poll() {
+    if (!started) return;
+    PROFILE_ZONE("assetPoll");
+    if (!fontsLoaded && isReady(pendingFonts)) {
+        for (auto& loaded : pendingFonts.get()) {
+            renderer->addFont(loaded.name, loaded.font, loaded.sheet);
+        }
+        finishedItems += fontItems;
+        finishFonts();
+    }
+
+    if (texturesLoaded) return;
+    if (!packedTextures.empty()) {
+        uploadPackedTextures();
+        return;
+    }
+    bool pending = false;
+    for (auto& image : pendingImages) {
+        if (!image.valid()) continue;
+        if (!isReady(image)) {
+            pending = true;
+            continue;
+        }
+        LoadedImage loaded = image.get();
+        if (loaded.surface) renderer->loadTextureFromSurface(loaded.name, loaded.surface);
+        finishedItems++;
+    }
+    if (!pending) finishTextures();
+}
+
+void AssetLoader::uploadPackedTextures() {
+    const pack::PackEntry* atlas = assetPack.find("atlas");
+    Renderer::TextureHandle atlasTexture = atlas
+        ? renderer->loadTextureFromPixels("atlas", assetPack.data(*atlas), atlas->width, atlas->height)
+        : Renderer::INVALID_TEXTURE;
+
+    // Sprites are regions of the one atlas texture
+    for (const auto& request : packedTextures) {
+        const pack::PackEntry* entry = assetPack.find(request.name);
+        if (entry && entry->type == pack::REGION) {
+            renderer->addTextureRegion(request.name, atlasTexture, entry->x, entry->y, entry->width, entry->height);
+        }
+        finishedItems++;
+    }
+    packedTextures.clear();
+    finishTextures();
+}
+
+void AssetLoader::finishFonts() {
+    fontsLoaded = true;
+    fontsPromise.set_value();
+    for (auto& callback : fontCallbacks) callback();
+    fontCallbacks.clear();
+}
+
+void AssetLoader::finishTextures() {
+    texturesLoaded = true;
+    pendingImages.clear();
+    texturesPromise.set_value();
+    for (auto& callback : textureCallbacks) callback();
+    textureCallbacks.clear();
+}
+
+void AssetLoader::shutdown() {
+    // Results that never reached the renderer are released here
+    if (pendingFonts.valid()) {
+        for (auto& loaded : pendingFonts.get()) {
+            if (loaded.sheet.surface) SDL_DestroySurface(loaded.sheet.surface);
+            TTF_CloseFont(loaded.font);
+        }
+    }
+    for (auto& image : pendingImages) {
+        if (!image.valid()) continue;
+        LoadedImage loaded = image.get();
+        if (loaded.surface) SDL_DestroySurface(loaded.surface);
+    }
+    pendingImages.clear();
+}
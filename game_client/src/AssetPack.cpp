@@ -0,0 +1,106 @@
+#include "../include/AssetPack.h"
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+bool AssetPack::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    base = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    fileHandle = file;
+    mappingHandle = mapping;
+    length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+        base = static_cast<const uint8_t*>(mapped);
+        length = static_cast<size_t>(info.st_size);
+    }
+#endif
+    if (!base) {
+        close();
+        return false;
+    }
+
+    // Validate the header and that every entry lies inside the file
+    const auto* header = reinterpret_cast<const pack::PackHeader*>(base);
+    if (length < sizeof(pack::PackHeader) || std::memcmp(header->magic, pack::MAGIC, 4) != 0 ||
+        header->version != pack::VERSION ||
+        header->entryCount > (length - sizeof(pack::PackHeader)) / sizeof(pack::PackEntry)) {
+        std::cerr << "Invalid asset pack: " << path << std::endl;
+        close();
+        return false;
+    }
+    entries = reinterpret_cast<const pack::PackEntry*>(base + sizeof(pack::PackHeader));
+    entryCount = header->entryCount;
+    for (uint32_t i = 0; i < entryCount; i++) {
+        const pack::PackEntry& e = entries[i];
+        if (e.offset > length || e.size > length - e.offset || e.name[pack::NAME_LENGTH - 1] != '\0' ||
+            (e.type == pack::REGION && e.parent >= entryCount)) {
+            std::cerr << "Corrupt asset pack entry " << i << " in " << path << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetPack::close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (base) munmap(const_cast<uint8_t*>(base), length);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+    base = nullptr;
+    length = 0;
+    entries = nullptr;
+    entryCount = 0;
+}
+
+const pack::PackEntry* AssetPack::find(const std::string& name) const {
+    for (uint32_t i = 0; i < entryCount; i++) {
+        if (name == entries[i].name) return &entries[i];
+    }
+    return nullptr;
+}
+
+const pack::PackEntry* AssetPack::entry(uint32_t index) const {
+    return index < entryCount ? &entries[index] : nullptr;
+}
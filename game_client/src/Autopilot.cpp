@@ -0,0 +1,131 @@
+#include "../include/Autopilot.h"
+
+namespace {
+
+class ChasePolicy : public AutopilotPolicy {
+public:
+    int chooseActions(const Simulation& sim, int player, Simulation::Action actions[MAX_ACTIONS]) override {
+        return chooseAutopilotActions(sim, player, actions);
+    }
+};
+
+class SweepPolicy : public AutopilotPolicy {
+public:
+    int chooseActions(const Simulation& sim, int player, Simulation::Action actions[MAX_ACTIONS]) override {
+        int x = sim.getPlayer(player).x;
+        if (x <= 0) right = true;
+        if (x >= sim.getColumns() - 1) right = false;
+        actions[0] = right ? Simulation::Action::MOVE_RIGHT : Simulation::Action::MOVE_LEFT;
+        actions[1] = Simulation::Action::FIRE;
+        return 2;
+    }
+
+private:
+    bool right = true;
+};
+
+class RandomPolicy : public AutopilotPolicy {
+public:
+    explicit RandomPolicy(uint64_t seed) : rng(seed) {}
+
+    int chooseActions(const Simulation&, int, Simulation::Action actions[MAX_ACTIONS]) override {
+        int count = 0;
+        int move = rng.nextInt(0, 2);
+        if (move == 1) actions[count++] = Simulation::Action::MOVE_LEFT;
+        if (move == 2) actions[count++] = Simulation::Action::MOVE_RIGHT;
+        if (rng.nextInt(0, 1)) actions[count++] = Simulation::Action::FIRE;
+        return count;
+    }
+
+private:
+    Xoshiro256 rng;
+};
+
+// Chase with a player's limits: a new target is only noticed after a
+// reaction time, a move is now and then not made, and fire is not held down.
+// Late reactions to far targets let enemies through, so games end.
+class HumanPolicy : public AutopilotPolicy {
+public:
+    explicit HumanPolicy(uint64_t seed) : rng(seed) {}
+
+    int chooseActions(const Simulation& sim, int player, Simulation::Action actions[MAX_ACTIONS]) override {
+        const EntityStore& enemies = sim.getEnemies();
+        long target = -1;
+        for (size_t e = 0; e < enemies.size(); e++) {
+            if (target < 0 || enemies.getY(e) > enemies.getY(target)) target = e;
+        }
+        int targetX = target >= 0 ? enemies.getX(target) : -1;
+        if (targetX != trackedX) {
+            trackedX = targetX;
+            reaction = rng.nextInt(MIN_REACTION_TICKS, MAX_REACTION_TICKS);
+        }
+        if (reaction > 0) {
+            reaction--;
+            return 0;
+        }
+
+        int count = 0;
+        int x = sim.getPlayer(player).x;
+        if (targetX >= 0 && targetX != x && rng.nextInt(0, 99) >= HESITATE_PERCENT) {
+            actions[count++] = targetX < x ? Simulation::Action::MOVE_LEFT : Simulation::Action::MOVE_RIGHT;
+        }
+        if (rng.nextInt(0, 99) < FIRE_PERCENT) actions[count++] = Simulation::Action::FIRE;
+        return count;
+    }
+
+private:
+    static const int MIN_REACTION_TICKS = 2;
+    static const int MAX_REACTION_TICKS = 6;
+    static const int HESITATE_PERCENT = 15;
+    static const int FIRE_PERCENT = 80;
+
+    Xoshiro256 rng;
+    int trackedX = -1;
+    int reaction = 0;
+};
+
+}
+
+int chooseAutopilotActions(const Simulation& sim, int player, Simulation::Action actions[2]) {
+    if (sim.getGameState() != Simulation::PLAYING || player >= sim.getPlayerCount()) return 0;
+
+    const EntityStore& enemies = sim.getEnemies();
+    int x = sim.getPlayer(player).x;
+    long target = -1;
+    for (size_t e = 0; e < enemies.size(); e++) {
+        if (target < 0 || enemies.getY(e) > enemies.getY(target)) target = e;
+    }
+    int count = 0;
+    if (target >= 0 && enemies.getX(target) < x) {
+        actions[count++] = Simulation::Action::MOVE_LEFT;
+    } else if (target >= 0 && enemies.getX(target) > x) {
+        actions[count++] = Simulation::Action::MOVE_RIGHT;
+    }
+    actions[count++] = Simulation::Action::FIRE;
+    return count;
+}
+
+void driveAutopilot(Simulation& sim, int player) {
+    Simulation::Action actions[2];
+    int count = chooseAutopilotActions(sim, player, actions);
+    for (int i = 0; i < count; i++) sim.applyAction(actions[i], player);
+}
+
+void AutopilotPolicy::drive(Simulation& sim, int player) {
+    if (sim.getGameState() != Simulation::PLAYING || player >= sim.getPlayerCount()) return;
+    Simulation::Action actions[MAX_ACTIONS];
+    int count = chooseActions(sim, player, actions);
+    for (int i = 0; i < count; i++) sim.applyAction(actions[i], player);
+}
+
+std::unique_ptr<AutopilotPolicy> makeAutopilotPolicy(const std::string& name, uint64_t seed) {
+    if (name == "human") return std::make_unique<HumanPolicy>(seed);
+    if (name == "chase") return std::make_unique<ChasePolicy>();
+    if (name == "sweep") return std::make_unique<SweepPolicy>();
+    if (name == "random") return std::make_unique<RandomPolicy>(seed);
+    return nullptr;
+}
+
+const char* autopilotPolicyNames() {
+    return "human, chase, sweep, random";
+}
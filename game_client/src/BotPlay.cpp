@@ -0,0 +1,225 @@
+#include "../include/BotPlay.h"
+#include "../include/Autopilot.h"
+#include "../include/Simulation.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace {
+
+template <typename T>
+T percentile(std::vector<T> values, double fraction) {
+    if (values.empty()) return T();
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// One line of a text histogram: the share of count in total as a bar
+void printBar(std::ostream& out, const char* label, uint64_t count, uint64_t total) {
+    const int WIDTH = 40;
+    double share = total ? static_cast<double>(count) / total : 0;
+    char line[128];
+    std::snprintf(line, sizeof(line), "    %-16s %6.2f%% ", label, 100 * share);
+    out << line << std::string(static_cast<size_t>(share * WIDTH + 0.5), '#') << std::endl;
+}
+
+}
+
+BotPlay::BotPlay(const BotPlayConfig& config) : config(config) {}
+
+bool BotPlay::run() {
+    if (!makeAutopilotPolicy(config.policy, 0)) {
+        std::cerr << "Unknown policy " << config.policy << " (known: " << autopilotPolicyNames() << ")" << std::endl;
+        return false;
+    }
+    threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, static_cast<unsigned>(std::max(config.sessions, 1)));
+    sessions.assign(static_cast<size_t>(std::max(config.sessions, 0)), Session{});
+    std::fill(std::begin(tickCost), std::end(tickCost), 0);
+    ticks = 0;
+
+    // Workers take the next unplayed session until none are left, so long
+    // sessions do not hold up a fixed share. Each restarts one Simulation of
+    // its own and counts into its own histogram, so that workers share
+    // nothing while playing.
+    std::vector<Worker> workers(threads);
+    std::atomic<int> next{0};
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> done;
+        for (Worker& worker : workers) {
+            done.push_back(pool.submit([this, &worker, &next] {
+                Simulation sim(config.columns * Simulation::TILE_SIZE, config.rows * Simulation::TILE_SIZE, config.seed);
+                for (int index = next++; index < config.sessions; index = next++) {
+                    playSession(index, sim, worker);
+                }
+            }));
+        }
+        for (auto& result : done) result.get();
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const Worker& worker : workers) {
+        for (int b = 0; b < COST_BUCKETS; b++) tickCost[b] += worker.tickCost[b];
+        ticks += worker.ticks;
+    }
+    return true;
+}
+
+void BotPlay::playSession(int index, Simulation& sim, Worker& worker) {
+    using Clock = std::chrono::steady_clock;
+    // Built up locally and stored once, as neighbouring sessions are played
+    // by other workers and share cache lines with this one
+    Session session = {};
+    session.seed = config.seed + static_cast<uint64_t>(index);
+
+    sim.restart(session.seed);
+    std::unique_ptr<AutopilotPolicy> policy = makeAutopilotPolicy(config.policy, session.seed);
+    sim.applyAction(Simulation::Action::CONFIRM);
+
+    long tick = 0;
+    while (sim.getGameState() == Simulation::PLAYING && tick < config.maxTicks) {
+        auto before = Clock::now();
+        policy->drive(sim);
+        sim.update();
+        auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - before).count();
+        worker.tickCost[std::min<int>(COST_BUCKETS - 1, std::bit_width(static_cast<uint64_t>(cost)))]++;
+        tick++;
+
+        size_t enemies = sim.getEnemies().size();
+        size_t bullets = sim.getBullets().size();
+        size_t particles = sim.getParticles().size();
+        session.peakEnemies = std::max(session.peakEnemies, enemies);
+        session.peakBullets = std::max(session.peakBullets, bullets);
+        session.peakParticles = std::max(session.peakParticles, particles);
+        session.peakEntities = std::max(session.peakEntities, enemies + bullets + particles);
+    }
+    worker.ticks += static_cast<uint64_t>(tick);
+    session.score = sim.getScore();
+    session.ticks = tick;
+    session.cutOff = sim.getGameState() == Simulation::PLAYING;
+    sessions[index] = session;
+}
+
+uint64_t BotPlay::resultHash() const {
+    // FNV-1a, as Simulation::stateHash
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++, value >>= 8) hash = (hash ^ (value & 0xff)) * 0x100000001b3ull;
+    };
+    for (const Session& session : sessions) {
+        mix(session.seed);
+        mix(static_cast<uint64_t>(session.score));
+        mix(static_cast<uint64_t>(session.ticks));
+    }
+    return hash;
+}
+
+void BotPlay::report(std::ostream& out) const {
+    char line[256];
+    std::snprintf(line, sizeof(line), "Bot play: %zu sessions of %s on a %dx%d grid, seeds %llu..%llu, %u threads",
+                  sessions.size(), config.policy.c_str(), config.columns, config.rows,
+                  static_cast<unsigned long long>(config.seed),
+                  static_cast<unsigned long long>(config.seed + sessions.size() - 1), threads);
+    out << line << std::endl;
+    if (sessions.empty()) return;
+
+    std::vector<int> scores;
+    std::vector<long> lengths;
+    std::vector<size_t> enemies, bullets, particles, entities;
+    int cutOff = 0;
+    double scoreSum = 0;
+    for (const Session& session : sessions) {
+        scores.push_back(session.score);
+        lengths.push_back(session.ticks);
+        enemies.push_back(session.peakEnemies);
+        bullets.push_back(session.peakBullets);
+        particles.push_back(session.peakParticles);
+        entities.push_back(session.peakEntities);
+        cutOff += session.cutOff;
+        scoreSum += session.score;
+    }
+
+    std::snprintf(line, sizeof(line), "  %.2f s, %.1f sessions/s, %.0f ticks/s", seconds, sessionsPerSecond(),
+                  seconds > 0 ? ticks / seconds : 0.0);
+    out << line << std::endl;
+
+    std::snprintf(line, sizeof(line), "  Score:  mean %.1f, min %d, p10 %d, p50 %d, p90 %d, p99 %d, max %d",
+                  scoreSum / sessions.size(), percentile(scores, 0), percentile(scores, 0.1),
+                  percentile(scores, 0.5), percentile(scores, 0.9), percentile(scores, 0.99),
+                  percentile(scores, 1.0));
+    out << line << std::endl;
+
+    // Ten equal ranges between the lowest and highest score
+    int low = percentile(scores, 0);
+    int high = percentile(scores, 1.0);
+    int step = std::max(1, (high - low + 10) / 10);
+    uint64_t counts[10] = {};
+    for (int score : scores) counts[std::min(9, (score - low) / step)]++;
+    for (int b = 0; b < 10 && low + b * step <= high; b++) {
+        char label[32];
+        if (step == 1) {
+            std::snprintf(label, sizeof(label), "%d", low + b);
+        } else {
+            std::snprintf(label, sizeof(label), "%d-%d", low + b * step, low + (b + 1) * step - 1);
+        }
+        printBar(out, label, counts[b], sessions.size());
+    }
+
+    std::snprintf(line, sizeof(line), "  Length: mean %.1f ticks, min %ld, p10 %ld, p50 %ld, p90 %ld, p99 %ld, max %ld",
+                  static_cast<double>(ticks) / sessions.size(), percentile(lengths, 0), percentile(lengths, 0.1),
+                  percentile(lengths, 0.5), percentile(lengths, 0.9), percentile(lengths, 0.99),
+                  percentile(lengths, 1.0));
+    out << line << std::endl;
+    if (cutOff > 0) out << "  " << cutOff << " sessions still playing at " << config.maxTicks << " ticks" << std::endl;
+    if (cutOff * 2 > static_cast<int>(sessions.size())) {
+        out << "  Warning: most sessions were cut off, so the score and length figures describe --max-ticks, not "
+            << config.policy << std::endl;
+    }
+
+    std::snprintf(line, sizeof(line),
+                  "  Peak entities: p50 %zu, max %zu (enemies %zu/%zu, bullets %zu/%zu, particles %zu/%zu p50/max)",
+                  percentile(entities, 0.5), percentile(entities, 1.0), percentile(enemies, 0.5),
+                  percentile(enemies, 1.0), percentile(bullets, 0.5), percentile(bullets, 1.0),
+                  percentile(particles, 0.5), percentile(particles, 1.0));
+    out << line << std::endl;
+
+    // Percentiles to within the power of two they fall in
+    auto costPercentile = [this](double fraction) {
+        uint64_t rank = static_cast<uint64_t>(fraction * ticks);
+        uint64_t seen = 0;
+        for (int b = 0; b < COST_BUCKETS; b++) {
+            seen += tickCost[b];
+            if (seen > rank) return b == 0 ? 0.0 : static_cast<double>(1ull << b) / 1000;
+        }
+        return static_cast<double>(1ull << (COST_BUCKETS - 1)) / 1000;
+    };
+    std::snprintf(line, sizeof(line), "  Tick cost: p50 < %.3g us, p99 < %.3g us, p99.99 < %.3g us", costPercentile(0.5),
+                  costPercentile(0.99), costPercentile(0.9999));
+    out << line << std::endl;
+    int first = 0;
+    int last = COST_BUCKETS - 1;
+    while (first < last && tickCost[first] == 0) first++;
+    while (last > first && tickCost[last] == 0) last--;
+    for (int b = first; b <= last; b++) {
+        char label[32];
+        if (b == COST_BUCKETS - 1) {
+            std::snprintf(label, sizeof(label), ">= %.4g us", (1ull << (b - 1)) / 1000.0);
+        } else {
+            std::snprintf(label, sizeof(label), "< %.4g us", (1ull << b) / 1000.0);
+        }
+        printBar(out, label, tickCost[b], ticks);
+    }
+
+    std::snprintf(line, sizeof(line), "  Result hash: %016llx", static_cast<unsigned long long>(resultHash()));
+    out << line << std::endl;
+}
@@ -0,0 +1,129 @@
+#include "../include/CollisionGrid.h"
+#include <algorithm>
+#include <bit>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+void findHitsNestedLoop(const EntityStore& bullets, const EntityStore& enemies, std::vector<Hit>& hits) {
+    hits.clear();
+    const int16_t *bx = bullets.xData(), *by = bullets.yData();
+    const int16_t *ex = enemies.xData(), *ey = enemies.yData();
+    for (int i = 0; i < static_cast<int>(bullets.size()); i++) {
+        for (int j = 0; j < static_cast<int>(enemies.size()); j++) {
+            if (bx[i] == ex[j] && by[i] == ey[j]) {
+                hits.push_back({i, j});
+            }
+        }
+    }
+}
+
+CollisionGrid::CollisionGrid(int columns, int rows) : columns(0), rows(0), wordsPerRow(0) {
+    resize(columns, rows);
+}
+
+void CollisionGrid::resize(int newColumns, int newRows) {
+    columns = newColumns;
+    rows = newRows;
+    wordsPerRow = (columns + 63) / 64;
+
+    size_t words = static_cast<size_t>(rows) * wordsPerRow;
+    enemyBoard.assign(words, 0);
+    bulletBoard.assign(words, 0);
+    hitBoard.assign(words, 0);
+    cellHead.assign(static_cast<size_t>(columns) * rows, -1);
+}
+
+void CollisionGrid::findHits(const EntityStore& bullets, const EntityStore& enemies, std::vector<Hit>& hits) {
+    hits.clear();
+    if (prepare(bullets, enemies)) {
+        collectHits(bullets, 0, bullets.size(), hits);
+    }
+}
+
+bool CollisionGrid::prepare(const EntityStore& bullets, const EntityStore& enemies) {
+    clear();
+
+    const int16_t *bx = bullets.xData(), *by = bullets.yData();
+    const int16_t *ex = enemies.xData(), *ey = enemies.yData();
+
+    // Enemies are chained in reverse so each cell lists them in index order
+    nextEnemy.resize(enemies.size());
+    for (int j = static_cast<int>(enemies.size()) - 1; j >= 0; j--) {
+        if (!inBounds(ex[j], ey[j])) continue;
+        int cell = cellIndex(ex[j], ey[j]);
+        nextEnemy[j] = cellHead[cell];
+        cellHead[cell] = j;
+        enemyBoard[wordIndex(ex[j], ey[j])] |= bitMask(ex[j]);
+    }
+
+    for (size_t i = 0; i < bullets.size(); i++) {
+        if (inBounds(bx[i], by[i])) bulletBoard[wordIndex(bx[i], by[i])] |= bitMask(bx[i]);
+    }
+
+    return intersect();
+}
+
+void CollisionGrid::collectHits(const EntityStore& bullets, size_t begin, size_t end, std::vector<Hit>& hits) const {
+    const int16_t *bx = bullets.xData(), *by = bullets.yData();
+    for (int i = static_cast<int>(begin); i < static_cast<int>(end); i++) {
+        if (!inBounds(bx[i], by[i]) || !(hitBoard[wordIndex(bx[i], by[i])] & bitMask(bx[i]))) continue;
+        for (int j = cellHead[cellIndex(bx[i], by[i])]; j >= 0; j = nextEnemy[j]) {
+            hits.push_back({i, j});
+        }
+    }
+}
+
+void CollisionGrid::clear() {
+    // Only cells that held an enemy last time have a chain head to reset
+    for (int y = 0; y < rows; y++) {
+        for (int w = 0; w < wordsPerRow; w++) {
+            uint64_t bits = enemyBoard[static_cast<size_t>(y) * wordsPerRow + w];
+            while (bits) {
+                int x = w * 64 + std::countr_zero(bits);
+                cellHead[cellIndex(x, y)] = -1;
+                bits &= bits - 1;
+            }
+        }
+    }
+    std::fill(enemyBoard.begin(), enemyBoard.end(), 0);
+    std::fill(bulletBoard.begin(), bulletBoard.end(), 0);
+}
+
+bool CollisionGrid::intersect() {
+    const size_t words = hitBoard.size();
+    const uint64_t *enemy = enemyBoard.data();
+    const uint64_t *bullet = bulletBoard.data();
+    uint64_t *hit = hitBoard.data();
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    __m256i any = _mm256_setzero_si256();
+    for (; i + 4 <= words; i += 4) {
+        __m256i h = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(enemy + i)),
+                                     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bullet + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hit + i), h);
+        any = _mm256_or_si256(any, h);
+    }
+    bool found = !_mm256_testz_si256(any, any);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128i any = _mm_setzero_si128();
+    for (; i + 2 <= words; i += 2) {
+        __m128i h = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(enemy + i)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(bullet + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hit + i), h);
+        any = _mm_or_si128(any, h);
+    }
+    bool found = _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF;
+#else
+    bool found = false;
+#endif
+
+    for (; i < words; i++) {
+        hit[i] = enemy[i] & bullet[i];
+        found |= hit[i] != 0;
+    }
+    return found;
+}
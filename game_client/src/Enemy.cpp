@@ -1,2 +0,0 @@
-#include "../include/Enemy.h"
-Enemy::Enemy(int x_, int y_) : x(x_), y(y_), dead(false) {}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "../include/EntityStore.h"
+#include <algorithm>
+#include <cstring>
+
+EntityHandle EntityStore::spawn(int x, int y) {
+    size_t index = xs.size();
+    xs.push_back(static_cast<int16_t>(x));
+    ys.push_back(static_cast<int16_t>(y));
+    prevXs.push_back(static_cast<int16_t>(x));
+    prevYs.push_back(static_cast<int16_t>(y));
+    if ((index >> 6) >= alive.size()) alive.push_back(0);
+    setAlive(index, true);
+
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slotToDense.size());
+        slotToDense.push_back(0);
+        slotGeneration.push_back(0);
+    }
+    slotToDense[slot] = static_cast<uint32_t>(index);
+    denseToSlot.push_back(slot);
+
+    return {slot, slotGeneration[slot]};
+}
+
+void EntityStore::despawn(size_t index) {
+    size_t last = xs.size() - 1;
+    uint32_t slot = denseToSlot[index];
+
+    // Move the last entity into the hole
+    if (index != last) {
+        xs[index] = xs[last];
+        ys[index] = ys[last];
+        prevXs[index] = prevXs[last];
+        prevYs[index] = prevYs[last];
+        setAlive(index, isAlive(last));
+        denseToSlot[index] = denseToSlot[last];
+        slotToDense[denseToSlot[index]] = static_cast<uint32_t>(index);
+    }
+    setAlive(last, false);
+
+    xs.pop_back();
+    ys.pop_back();
+    prevXs.pop_back();
+    prevYs.pop_back();
+    denseToSlot.pop_back();
+
+    // Invalidate outstanding handles to the removed entity
+    slotGeneration[slot]++;
+    freeSlots.push_back(slot);
+}
+
+void EntityStore::clear() {
+    for (uint32_t slot : denseToSlot) {
+        slotGeneration[slot]++;
+        freeSlots.push_back(slot);
+    }
+    xs.clear();
+    ys.clear();
+    prevXs.clear();
+    prevYs.clear();
+    denseToSlot.clear();
+    std::fill(alive.begin(), alive.end(), 0);
+}
+
+void EntityStore::reserve(size_t capacity) {
+    xs.reserve(capacity);
+    ys.reserve(capacity);
+    prevXs.reserve(capacity);
+    prevYs.reserve(capacity);
+    alive.reserve((capacity + 63) / 64);
+    denseToSlot.reserve(capacity);
+    slotToDense.reserve(capacity);
+    slotGeneration.reserve(capacity);
+    freeSlots.reserve(capacity);
+}
+
+void EntityStore::assign(const int16_t* x, const int16_t* y, const int16_t* prevX, const int16_t* prevY,
+                         size_t count) {
+    clear();
+    xs.assign(x, x + count);
+    ys.assign(y, y + count);
+    prevXs.assign(prevX, prevX + count);
+    prevYs.assign(prevY, prevY + count);
+
+    alive.assign((count + 63) / 64, ~uint64_t(0));
+    if (count % 64) alive.back() = (uint64_t(1) << (count % 64)) - 1;
+
+    denseToSlot.resize(count);
+    for (size_t index = 0; index < count; index++) {
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slotToDense.size());
+            slotToDense.push_back(0);
+            slotGeneration.push_back(0);
+        }
+        slotToDense[slot] = static_cast<uint32_t>(index);
+        denseToSlot[index] = slot;
+    }
+}
+
+void EntityStore::removeDead() {
+    // Walking backwards means whatever gets swapped in has already been checked
+    for (size_t i = xs.size(); i-- > 0;) {
+        if (!isAlive(i)) despawn(i);
+    }
+}
+
+long EntityStore::find(EntityHandle handle) const {
+    if (handle.slot >= slotGeneration.size() || slotGeneration[handle.slot] != handle.generation) {
+        return -1;
+    }
+    return slotToDense[handle.slot];
+}
+
+void EntityStore::moveY(int dy, size_t begin, size_t end) {
+    int16_t *y = ys.data();
+    const int16_t delta = static_cast<int16_t>(dy);
+    for (size_t i = begin; i < end; i++) {
+        y[i] = static_cast<int16_t>(y[i] + delta);
+    }
+}
+
+void EntityStore::savePreviousPositions(size_t begin, size_t end) {
+    if (begin >= end) return;
+    std::memcpy(prevXs.data() + begin, xs.data() + begin, (end - begin) * sizeof(int16_t));
+    std::memcpy(prevYs.data() + begin, ys.data() + begin, (end - begin) * sizeof(int16_t));
+}
+
+void EntityStore::setAlive(size_t index, bool value) {
+    uint64_t mask = uint64_t(1) << (index & 63);
+    if (value) {
+        alive[index >> 6] |= mask;
+    } else {
+        alive[index >> 6] &= ~mask;
+    }
+}
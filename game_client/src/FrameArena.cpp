@@ -0,0 +1,39 @@
+#include "../include/FrameArena.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+FrameArena::FrameArena(size_t capacity) : block(new uint8_t[capacity]), size(capacity) {}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+    size_t start = ((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+    requested += start - offset + bytes;
+    peak = std::max(peak, requested);
+    if (start + bytes > size) return nullptr;
+    offset = start + bytes;
+    return block.get() + start;
+}
+
+std::string_view FrameArena::format(const char* fmt, ...) {
+    // Formats straight into the free space, then keeps only what was written
+    char* out = reinterpret_cast<char*>(block.get() + offset);
+    size_t available = size - offset;
+    va_list args;
+    va_start(args, fmt);
+    int length = std::vsnprintf(available ? out : nullptr, available, fmt, args);
+    va_end(args);
+    if (length < 0) return {};
+
+    size_t wanted = static_cast<size_t>(length) + 1;
+    requested += wanted;
+    peak = std::max(peak, requested);
+    size_t kept = std::min(wanted, available);
+    offset += kept;
+    return {out, kept ? kept - 1 : 0};
+}
+
+void FrameArena::reset() {
+    offset = 0;
+    requested = 0;
+}
@@ -1,57 +1,246 @@
 #include "../include/Game.h"
-#include "../include/Utils.h"
+#include "../include/Profiler.h"
+#include "../include/StateSnapshot.h"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
-Game::Game(SDL_Window* window, int w, int h) 
-    : window(window), width(w), height(h), running(true), tick(0), score(0), 
-      player(w/2/TILE_SIZE, h/TILE_SIZE-1), currentState(MENU) {
+namespace {
+
+// CPU time used by the whole process so far, across all threads
+double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+    auto seconds = [](const FILETIME& time) {
+        return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 1e7;
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+}
+
+Game::Game(SDL_Window* window, int w, int h, uint64_t seed) 
+    : width(w), height(h), running(true), elapsedSeconds(0), window(window), renderer(nullptr), assetLoader(nullptr),
+      playerTexture(Renderer::INVALID_TEXTURE), enemyTexture(Renderer::INVALID_TEXTURE),
+      bulletTexture(Renderer::INVALID_TEXTURE), backgroundTexture(Renderer::INVALID_TEXTURE), sim(w, h, seed),
+      simThread(sim, recorder) {
+    
+    sim.setJobSystem(&jobs);
     
     // Create renderer
     renderer = new Renderer(window, width, height);
     
-    // Load sprite textures
-    renderer->loadTextureFromFile("player", "../assets/player_128.png");
-    renderer->loadTextureFromFile("enemy", "../assets/enemy_128.png");
-    renderer->loadTextureFromFile("bullet", "../assets/bullet_128.png");
-    renderer->loadTextureFromFile("background", "../assets/background.png");
+    // The background strip holds the image twice, so scrolling is one blit
+    backgroundLayer = renderer->createLayer("background", width, height * 2);
+    hudLayer = renderer->createLayer("hud", width, height);
+    menuLayer = renderer->createLayer("menu", width, height);
+    pausedLayer = renderer->createLayer("paused", width, height);
+    gameOverLayer = renderer->createLayer("gameOver", width, height);
+    
+    loadAssets();
     
-    // Load fonts
-    renderer->loadFont("pixel_large", "../assets/Pixel Game Extrude.otf", 48);
-    renderer->loadFont("pixel_medium", "../assets/Pixel Game.otf", 24);
-    renderer->loadFont("pixel_small", "../assets/Pixel Game.otf", 16);
+    std::cout << "Game initialized with " << sim.getColumns() << "x" << sim.getRows() << " game grid" << std::endl;
+}
+
+void Game::loadAssets() {
+    assetLoader = new AssetLoader(renderer);
     
-    // Initialize random seed
-    srand(static_cast<unsigned>(time(0)));
+    // Sprite handles are looked up once the textures have streamed in
+    assetLoader->onTexturesReady([this] {
+        playerTexture = renderer->getTexture("player");
+        enemyTexture = renderer->getTexture("enemy");
+        bulletTexture = renderer->getTexture("bullet");
+        backgroundTexture = renderer->getTexture("background");
+        std::cout << "Textures ready after " << SDL_GetTicksNS() / 1e6 << " ms" << std::endl;
+    });
+    assetLoader->onFontsReady([] {
+        std::cout << "Menu fonts ready after " << SDL_GetTicksNS() / 1e6 << " ms" << std::endl;
+    });
     
-    std::cout << "Game initialized with " << width/TILE_SIZE << "x" << height/TILE_SIZE << " game grid" << std::endl;
+    // Assets are found relative to the executable, not the working directory
+    const char* base = SDL_GetBasePath();
+    assetLoader->start(base ? base : "",
+        {
+            {"pixel_large", "Pixel Game Extrude.otf", 48},
+            {"pixel_medium", "Pixel Game.otf", 24},
+            {"pixel_small", "Pixel Game.otf", 16},
+        },
+        {
+            {"player", "player_128.png"},
+            {"enemy", "enemy_128.png"},
+            {"bullet", "bullet_128.png"},
+            {"background", "background.png"},
+        });
 }
 
 Game::~Game() {
+    simThread.stop();
+    recorder.close(sim);
+    
+    // Loader results still in flight hold fonts that must close before TTF shuts down
+    delete assetLoader;
     delete renderer;
 }
 
 void Game::run() {
-    Uint64 lastTime = SDL_GetTicks();
-    const Uint64 targetFrameTime = 1000 / 12; // 12 FPS for retro feel
+    // The simulation advances in fixed 12 Hz ticks on its own thread while
+    // this thread pumps events and renders the newest snapshot as often as
+    // the display allows; time since that snapshot's tick is the blend factor.
+    // Outside play nothing moves between ticks, so those screens are drawn
+    // only when they change and the loop sleeps on the event queue until the
+    // next tick is due, or until an event once the simulation has settled.
+    const double tickTime = static_cast<double>(SDL_NS_PER_SECOND) / Simulation::TICKS_PER_SECOND;
+    
+    Uint64 startTime = SDL_GetTicksNS();
+    double startCpu = processCpuSeconds();
+    Uint64 lastTime = startTime;
+    double lastCpu = startCpu;
+    uint64_t lastSimWakeups = 0;
+    bool wasStatic = false;
+    bool wasStill = false;
+    int64_t shownUpdate = 0;
+    uint32_t shownActions = 0;
+    loopStats = {};
+    simThread.start();
     
     while (running) {
-        Uint64 currentTime = SDL_GetTicks();
-        Uint64 deltaTime = currentTime - lastTime;
+        Uint64 currentTime = SDL_GetTicksNS();
+        double cpu = processCpuSeconds();
+        uint64_t simWakeups = simThread.getWakeups();
+        if (wasStatic) {
+            loopStats.idleSeconds += (currentTime - lastTime) / static_cast<double>(SDL_NS_PER_SECOND);
+            loopStats.idleCpuSeconds += cpu - lastCpu;
+            loopStats.idleWakeups += 1 + (simWakeups - lastSimWakeups);
+        }
+        loopStats.wakeups++;
+        
+        processInput();
+        assetLoader->poll();
+        
+        // Waiting the few microseconds the simulation thread takes to apply
+        // this frame's input saves a whole frame of latency; a still screen
+        // woken by a key always waits, as it is redrawn only for the change
+        const SimSnapshot& snapshot = lowLatencyInput || wasStill
+                                          ? simThread.latest(actionsPushed, std::chrono::milliseconds(2))
+                                          : simThread.latest();
+        bool playing = snapshot.state == Simulation::PLAYING;
+        if (playing) elapsedSeconds += (currentTime - lastTime) / static_cast<double>(SDL_NS_PER_SECOND);
+        lastTime = currentTime;
+        lastCpu = cpu;
+        lastSimWakeups = simWakeups;
+        
+        // The loading screen and the profiler overlay animate every frame
+        bool staticScreen = !playing && assetsReady() && !showProfiler;
+        bool still = idleWait && staticScreen;
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        if (!still || !wasStill || redrawRequested || snapshot.updateTime != shownUpdate ||
+            snapshot.actionsApplied != shownActions) {
+            // Outside play entities are shown where the tick left them
+            float alpha = playing ? static_cast<float>(std::clamp((now - snapshot.updateTime) / tickTime, 0.0, 1.0)) : 1.0f;
+            drawFrame(snapshot, alpha);
+            if (trackLatency) latency.framePresented(snapshot.actionsApplied, static_cast<int64_t>(SDL_GetTicksNS()));
+            profiler::endFrame();
+            loopStats.frames++;
+            shownUpdate = snapshot.updateTime;
+            shownActions = snapshot.actionsApplied;
+            redrawRequested = false;
+        }
+        
+        if (!firstFrameShown) {
+            firstFrameShown = true;
+            std::cout << "First frame after " << SDL_GetTicksNS() / 1e6 << " ms" << std::endl;
+        }
         
-        if (deltaTime >= targetFrameTime) {
-            processInput();
-            update();
-            render();
-            lastTime = currentTime;
+        wasStatic = staticScreen;
+        wasStill = still;
+        if (still) {
+            // Events stay queued for processInput(); the deadline is kept in
+            // nanoseconds and rounded up, so the wait never ends early
+            if (snapshot.settled) {
+                SDL_WaitEvent(nullptr);
+            } else {
+                double untilTick = snapshot.updateTime + tickTime - now;
+                SDL_WaitEventTimeout(nullptr, std::max(1, static_cast<int>(std::ceil(untilTick / 1e6))));
+            }
         }
+    }
+    
+    simThread.stop();
+    loopStats.seconds = (SDL_GetTicksNS() - startTime) / static_cast<double>(SDL_NS_PER_SECOND);
+    loopStats.cpuSeconds = processCpuSeconds() - startCpu;
+    loopStats.wakeups += simThread.getWakeups();
+}
+
+void Game::runClient(NetClient& client) {
+    // Frames arrive at the host's tick rate and are blended like local ticks,
+    // from the time each one arrived
+    const double tickTime = static_cast<double>(SDL_NS_PER_SECOND) / Simulation::TICKS_PER_SECOND;
+    
+    Uint64 startTime = SDL_GetTicksNS();
+    netClient = &client;
+    
+    while (running && client.isConnected()) {
+        Uint64 currentTime = SDL_GetTicksNS();
+        elapsedSeconds = (currentTime - startTime) / static_cast<double>(SDL_NS_PER_SECOND);
         
-        // Small delay to prevent excessive CPU usage
+        processInput();
+        client.poll();
+        assetLoader->poll();
+        
+        stepSnapshot.capture(client.getSimulation(), client.getPlayer());
+        stepSnapshot.updateTime = client.getFrameTime();
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        float alpha = static_cast<float>(std::clamp((now - stepSnapshot.updateTime) / tickTime, 0.0, 1.0));
+        drawFrame(stepSnapshot, alpha);
+        profiler::endFrame();
+    }
+    
+    client.disconnect();
+    netClient = nullptr;
+}
+
+void Game::runStress(StressTest& stress) {
+    while (running && !assetsReady()) {
+        assetLoader->poll();
         SDL_Delay(1);
     }
+    
+    while (running && !stress.finished()) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_EVENT_QUIT) running = false;
+        }
+        
+        stress.tick();
+        stress.render(*this);
+        profiler::endFrame();
+    }
+}
+
+void Game::step(int ticks, float alpha) {
+    assetLoader->poll();
+    for (int i = 0; i < ticks; i++) {
+        update();
+    }
+    stepSnapshot.capture(sim);
+    drawFrame(stepSnapshot, alpha);
+    profiler::endFrame();
 }
 
 void Game::processInput() {
+    PROFILE_ZONE("processInput");
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         switch (event.type) {
@@ -59,162 +248,239 @@ void Game::processInput() {
                 running = false;
                 break;
                 
+            // Render target contents can be lost with the device, and a new
+            // pixel size changes how they scale
+            case SDL_EVENT_RENDER_TARGETS_RESET:
+            case SDL_EVENT_RENDER_DEVICE_RESET:
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                renderer->invalidateLayers();
+                redrawRequested = true;
+                break;
+                
+            case SDL_EVENT_WINDOW_EXPOSED:
+                redrawRequested = true;
+                break;
+                
             case SDL_EVENT_KEY_DOWN:
-                switch (currentState) {
-                    case MENU:
-                        if (event.key.key == SDLK_SPACE || event.key.key == SDLK_RETURN) {
-                            setGameState(PLAYING);
-                            reset();
-                        }
+                switch (event.key.key) {
+                    case SDLK_SPACE:
+                        applyAction(Simulation::Action::FIRE, event.key.timestamp);
                         break;
-                        
-                    case PLAYING:
-                        switch (event.key.key) {
-                            case SDLK_ESCAPE:
-                                setGameState(PAUSED);
-                                break;
-                            case SDLK_SPACE:
-                                // Shoot bullet
-                                bullets.push_back(Bullet(player.x, player.y - 1));
-                                break;
-                        }
-                        
-                        // Use scancodes for movement
-                        switch (event.key.scancode) {
-                            case SDL_SCANCODE_A:
-                                player.moveLeft();
-                                break;
-                            case SDL_SCANCODE_D:
-                                player.moveRight(width / TILE_SIZE);
-                                break;
-                            default:
-                                // Do nothing for other scancodes
-                                break;
-                        }
+                    case SDLK_RETURN:
+                        applyAction(Simulation::Action::CONFIRM, event.key.timestamp);
+                        break;
+                    case SDLK_ESCAPE:
+                        applyAction(Simulation::Action::PAUSE, event.key.timestamp);
                         break;
-                        
-                    case PAUSED:
-                        if (event.key.key == SDLK_ESCAPE) {
-                            setGameState(PLAYING);
+                    case SDLK_F3:
+                        // Profiling stays on while a trace is being recorded
+                        showProfiler = !showProfiler;
+                        profiler::setEnabled(showProfiler || profiler::isTracing());
+                        break;
+                }
+                
+                // Use scancodes for movement
+                switch (event.key.scancode) {
+                    case SDL_SCANCODE_A:
+                        if (lowLatencyInput) {
+                            if (!event.key.repeat) pressMoveKey(heldKeys[0], event.key.timestamp);
+                        } else {
+                            applyAction(Simulation::Action::MOVE_LEFT, event.key.timestamp);
                         }
                         break;
-                        
-                    case GAME_OVER:
-                        if (event.key.key == SDLK_SPACE || event.key.key == SDLK_RETURN) {
-                            setGameState(MENU);
+                    case SDL_SCANCODE_D:
+                        if (lowLatencyInput) {
+                            if (!event.key.repeat) pressMoveKey(heldKeys[1], event.key.timestamp);
+                        } else {
+                            applyAction(Simulation::Action::MOVE_RIGHT, event.key.timestamp);
                         }
                         break;
+                    default:
+                        // Do nothing for other scancodes
+                        break;
                 }
                 break;
         }
     }
+    
+    if (lowLatencyInput) {
+        sampleHeldKeys();
+    }
 }
 
-void Game::reset() {
-    // Clear all enemies, bullets, and particles
-    enemies.clear();
-    bullets.clear();
-    particles.clear();
-    
-    // Reset player to initial position (center bottom)
-    player.x = (width / TILE_SIZE) / 2;
-    player.y = (height / TILE_SIZE) - 1;
-    
-    // Reset game state
-    tick = 0;
-    score = 0;
-    difficulty = 1.0;
-    enemiesSpawned = 0;
+void Game::pressMoveKey(HeldKey& key, Uint64 timestamp) {
+    // The press moves at once; while held, sampleHeldKeys() takes over from
+    // the OS key repeat
+    key.held = true;
+    key.nextStep = timestamp + moveInterval;
+    applyAction(key.action, timestamp);
 }
 
-void Game::update() {
-    if (currentState != PLAYING) return;
-    
-    tick++;
-    spawnEnemies();
+void Game::sampleHeldKeys() {
+    // Sampled after the event queue is drained; a press released within the
+    // frame has still moved once on its key-down event
+    const bool* keys = SDL_GetKeyboardState(nullptr);
+    Uint64 now = SDL_GetTicksNS();
+    for (HeldKey& key : heldKeys) {
+        key.held = key.held && keys[key.scancode];
+        if (!key.held) continue;
+        // After a stall, move once rather than catching up
+        if (now > key.nextStep + moveInterval) key.nextStep = now;
+        while (key.nextStep <= now) {
+            // Each move counts its latency from when it fell due
+            applyAction(key.action, key.nextStep);
+            key.nextStep += moveInterval;
+        }
+    }
+}
 
-    // Move bullets upward
-    for (auto &b: bullets) b.y--;
+bool Game::startRecording(const std::string& path) {
+    return recorder.open(path, sim);
+}
 
-    // Move enemies downward (slower - every 2 ticks instead of every tick)
-    if (tick % 2 == 0) {
-        for (auto &e: enemies) e.y++;
-    }
+void Game::enableUploads(UploadQueue& uploads) {
+    // Runs on the simulation thread, the queue's only producer
+    simThread.setGameOverHandler([&uploads](const Simulation& sim) {
+        upload::ScoreRecord score = {sim.getScore(), sim.getTick(), sim.getSeed(),
+                                     static_cast<int64_t>(std::time(nullptr))};
+        uploads.submitScore(score);
+        std::vector<uint8_t> snapshot;
+        encodeSnapshot(sim, snapshot);
+        uploads.submitSnapshot(std::move(snapshot));
+    });
+}
 
-    // Enhanced collision detection
-    for (auto &b : bullets) {
-        for (auto &e: enemies) {
-            if (b.x == e.x && b.y == e.y) {
-                e.dead = true;
-                b.dead = true;
-                score += 10;
-                // Create hit effect particles
-                createHitEffect(e.x, e.y);
-            }
-        }
-    }
+void Game::enableLowLatencyInput(double movesPerSecond) {
+    lowLatencyInput = true;
+    moveInterval = static_cast<Uint64>(SDL_NS_PER_SECOND / std::max(movesPerSecond, 1.0));
+}
 
-    // Remove bullets that are off-screen
-    removeOffScreenBullets();
+void Game::enableHosting(NetHost& host) {
+    // Client actions are applied within a couple of milliseconds rather than
+    // at the next tick
+    simThread.setNetworkHandlers([&host](Simulation& sim) { return host.poll(sim); },
+                                 [&host](const Simulation& sim) { host.afterUpdate(sim); },
+                                 std::chrono::milliseconds(2));
+}
+
+void Game::applyAction(Simulation::Action action, Uint64 inputTime) {
+    if (netClient) {
+        netClient->sendAction(action);
+    } else if (!simThread.pushAction(action)) {
+        std::cerr << "Input queue full, dropping action" << std::endl;
+    } else {
+        actionsPushed++;
+        if (trackLatency) latency.inputQueued(actionsPushed, static_cast<int64_t>(inputTime));
+    }
+}
 
-    // Remove dead entities
-    enemies.erase(std::remove_if(enemies.begin(), enemies.end(),
-                                [this](Enemy &e){ 
-                                    if (e.dead) return true;
-                                    if (e.y >= height / TILE_SIZE - 1) { 
-                                        setGameState(GAME_OVER);
-                                        return true; 
-                                    }
-                                    return false;
-                                }),
-                enemies.end());
-    
-    // Remove dead bullets
-    bullets.erase(std::remove_if(bullets.begin(), bullets.end(),
-                                [this](Bullet &b){ 
-                                    return b.dead; 
-                                }),
-                bullets.end());
-    
-    // Update particles
-    updateParticles();
+void Game::update() {
+    PROFILE_ZONE("update");
+    sim.update();
+    recorder.recordUpdate(sim);
 }
 
-void Game::render() {
+void Game::drawFrame(const SimSnapshot& snapshot, float alpha) {
+    PROFILE_ZONE("render");
     // Clear screen with dark background
     renderer->clear();
     renderer->setDrawColor(0, 0, 50); // Dark blue background
     
     // Render based on current game state
-    switch (currentState) {
-        case MENU:
-            renderMenu();
+    switch (snapshot.state) {
+        case Simulation::MENU:
+            if (assetLoader->areFontsReady()) {
+                renderMenu();
+            } else {
+                renderLoading();
+            }
             break;
-        case PLAYING:
-            renderGameplay();
+        case Simulation::PLAYING:
+            renderGameplay(snapshot, alpha);
             break;
-        case PAUSED:
-            renderGameplay();
+        case Simulation::PAUSED:
+            renderGameplay(snapshot, alpha);
             renderPaused();
             break;
-        case GAME_OVER:
-            renderGameplay();
-            renderGameOver();
+        case Simulation::GAME_OVER:
+            renderGameplay(snapshot, alpha);
+            renderGameOver(snapshot);
             break;
     }
     
+    if (showProfiler) {
+        renderProfilerOverlay();
+    }
+    
     // Present the frame
     renderer->present();
 }
 
-void Game::renderGameplay() {
+void Game::renderGameplay(const SimSnapshot& snapshot, float alpha) {
+    PROFILE_ZONE("renderGameplay");
     // Add downward-scrolling background
-    static float backgroundOffset = 0;
-    backgroundOffset += 0.5f; // Scroll speed in pixels per frame
-    if (backgroundOffset >= height) backgroundOffset -= height;
-    renderer->drawTexture("background", 0, backgroundOffset - height, width, height);
-    renderer->drawTexture("background", 0, backgroundOffset, width, height);
+    float backgroundOffset = static_cast<float>(std::fmod(elapsedSeconds * BACKGROUND_SCROLL_SPEED, height));
+    renderer->updateLayer(backgroundLayer, static_cast<uint64_t>(backgroundTexture + 1), [this] { renderBackground(); });
+    SDL_FRect backgroundSrc = {0, height - backgroundOffset, static_cast<float>(width), static_cast<float>(height)};
+    renderer->compositeLayer(backgroundLayer, 0, 0, &backgroundSrc);
     
+    // Title bar, score and border change only with the score
+    int score = snapshot.score;
+    uint64_t hudKey = (static_cast<uint64_t>(static_cast<uint32_t>(score)) << 1) | assetLoader->areFontsReady();
+    renderer->updateLayer(hudLayer, hudKey, [this, score] { renderHud(score); });
+    renderer->compositeLayer(hudLayer, 0, 0);
+    
+    // Draw player (moved by input rather than by ticks, so never interpolated)
+    renderer->setDrawColor(0, 255, 0); // Green player
+    float playerPixelX = gameToPixelX(snapshot.playerX);
+    float playerPixelY = gameToPixelY(snapshot.playerY); // Offset for title area
+
+    // Prevent drawing player outside the bottom of the window
+    if (playerPixelY + TILE_SIZE <= height) {
+        renderer->drawTexture(playerTexture, playerPixelX, playerPixelY, TILE_SIZE, TILE_SIZE);
+    }
+    
+    // Co-op players move at the host's ticks, so they are blended like enemies
+    const SimSnapshot::Entities& others = snapshot.others;
+    for (size_t i = 0; i < others.size(); i++) {
+        float otherPixelX = lerpToPixel(others.prevX[i], others.x[i], alpha);
+        float otherPixelY = lerpToPixel(others.prevY[i], others.y[i], alpha);
+        if (otherPixelY + TILE_SIZE <= height) {
+            renderer->drawTexture(playerTexture, otherPixelX, otherPixelY, TILE_SIZE, TILE_SIZE);
+        }
+    }
+    
+    // Draw bullets
+    const SimSnapshot::Entities& bullets = snapshot.bullets;
+    for (size_t i = 0; i < bullets.size(); i++) {
+        if (bullets.y[i] >= 0 && bullets.y[i] < height / TILE_SIZE) {
+            float bulletPixelX = lerpToPixel(bullets.prevX[i], bullets.x[i], alpha);
+            float bulletPixelY = lerpToPixel(bullets.prevY[i], bullets.y[i], alpha);
+            renderer->drawTexture(bulletTexture, bulletPixelX + TILE_SIZE/4, bulletPixelY + TILE_SIZE/4, TILE_SIZE/4, TILE_SIZE/2);
+        }
+    }
+    
+    // Draw enemies
+    renderer->setDrawColor(255, 0, 0); // Red enemies
+    const SimSnapshot::Entities& enemies = snapshot.enemies;
+    for (size_t i = 0; i < enemies.size(); i++) {
+        if (enemies.y[i] >= 0 && enemies.y[i] < height / TILE_SIZE) {
+            float enemyPixelX = lerpToPixel(enemies.prevX[i], enemies.x[i], alpha);
+            float enemyPixelY = lerpToPixel(enemies.prevY[i], enemies.y[i], alpha);
+            renderer->drawTexture(enemyTexture, enemyPixelX, enemyPixelY, TILE_SIZE, TILE_SIZE);
+        }
+    }
+    
+    // Render particles
+    renderParticles(snapshot, alpha);
+}
+
+void Game::renderBackground() {
+    renderer->drawTexture(backgroundTexture, 0, 0, width, height);
+    renderer->drawTexture(backgroundTexture, 0, height, width, height);
+}
+
+void Game::renderHud(int score) {
     // Draw title area with enhanced score display
     renderer->setDrawColor(100, 100, 255); // Light blue for title
     renderer->drawFillRect(0, 0, width, 60);
@@ -237,164 +503,120 @@ void Game::renderGameplay() {
     }
     
     // Draw score text
-    std::string scoreText = "Score: " + std::to_string(score);
-    renderer->drawText("pixel_small", scoreText, 20, 45, 255, 255, 255);
+    if (assetLoader->areFontsReady()) {
+        std::string_view scoreText = renderer->getFrameArena().format("Score: %d", score);
+        renderer->drawText("pixel_small", scoreText, 20, 45, 255, 255, 255);
+    }
     
     // Draw game area border
     renderer->setDrawColor(255, 255, 255); // White border
     renderer->drawRect(0, 60, width, height - 60);
-    
-    // Draw player
-    renderer->setDrawColor(0, 255, 0); // Green player
-    float playerPixelX = gameToPixelX(player.x);
-    float playerPixelY = gameToPixelY(player.y); // Offset for title area
+}
 
-    // Prevent drawing player outside the bottom of the window
-    if (playerPixelY + TILE_SIZE <= height) {
-        renderer->drawTexture("player", playerPixelX, playerPixelY, TILE_SIZE, TILE_SIZE);
-    }
+void Game::renderMenu() {
+    // Fonts are ready whenever the menu is drawn, so it never changes
+    renderer->updateLayer(menuLayer, 1, [this] {
+        // Draw title area
+        renderer->setDrawColor(100, 100, 255);
+        renderer->drawFillRect(0, 0, width, height);
     
-    // Draw bullets
-    for (auto &b : bullets) {
-        if (b.y >= 0 && b.y < height / TILE_SIZE) {
-            float bulletPixelX = gameToPixelX(b.x);
-            float bulletPixelY = gameToPixelY(b.y);
-            renderer->drawTexture("bullet", bulletPixelX + TILE_SIZE/4, bulletPixelY + TILE_SIZE/4, TILE_SIZE/4, TILE_SIZE/2);
-        }
-    }
+        // Draw title text - centered
+        renderer->drawTextCentered("pixel_large", "STAR DEFENDER", height/2 - 80, 255, 255, 255);
     
-    // Draw enemies
-    renderer->setDrawColor(255, 0, 0); // Red enemies
-    for (auto &e : enemies) {
-        if (e.y >= 0 && e.y < height / TILE_SIZE) {
-            float enemyPixelX = gameToPixelX(e.x);
-            float enemyPixelY = gameToPixelY(e.y);
-            renderer->drawTexture("enemy", enemyPixelX, enemyPixelY, TILE_SIZE, TILE_SIZE);
-        }
-    }
-    
-    // Render particles
-    renderParticles();
-}
-
-void Game::spawnEnemies() {
-    // Increase difficulty every 10 enemies
-    difficulty = 1.0f + (enemiesSpawned / 10) * 0.1f;
-
-    // Decrease spawn interval as difficulty increases
-    int spawnInterval = std::max(10, 30 - (int)(difficulty * 5));
-
-    if (tick % 30 == 0) { // Spawn every 30 ticks (about every 0.5 seconds at 60 FPS)
-        int gameWidth = width / TILE_SIZE;
-        enemies.push_back(Enemy(random_int(0, gameWidth - 1), 0));
-        enemiesSpawned++;
-    }
-}
-
-// Game state management
-void Game::setGameState(GameState newState) {
-    currentState = newState;
+        // Draw instructions - centered
+        renderer->drawTextCentered("pixel_medium", "Press SPACE or ENTER to Start", height/2 + 20, 200, 200, 200);
+        renderer->drawTextCentered("pixel_small", "Use A/D to move, SPACE to shoot", height/2 + 60, 180, 180, 180);
+        renderer->drawTextCentered("pixel_small", "Press ESC to pause during game", height/2 + 90, 180, 180, 180);
+    });
+    renderer->compositeLayer(menuLayer, 0, 0);
 }
 
-void Game::renderMenu() {
-    // Draw title area
+void Game::renderLoading() {
+    // Fonts are not available yet, so progress is shown as a bar only
     renderer->setDrawColor(100, 100, 255);
     renderer->drawFillRect(0, 0, width, height);
     
-    // Draw title text - centered
-    renderer->drawTextCentered("pixel_large", "STAR DEFENDER", height/2 - 80, 255, 255, 255);
+    float barWidth = width / 2.0f;
+    float barX = (width - barWidth) / 2.0f;
+    renderer->setDrawColor(50, 50, 100);
+    renderer->drawFillRect(barX, height / 2.0f - 10, barWidth, 20);
+    renderer->setDrawColor(255, 255, 255);
+    renderer->drawFillRect(barX, height / 2.0f - 10, barWidth * assetLoader->getProgress(), 20);
+}
+
+void Game::renderProfilerOverlay() {
+    if (!assetLoader->areFontsReady()) return;
+    
+    // Figures are from the previous frame, the latest one fully drained
+    const profiler::FrameSummary summary = profiler::frameSummary();
+    const std::vector<profiler::ZoneTotal>& zones = profiler::lastFrameZones();
+    const float lineHeight = 18;
+    const float panelWidth = 300;
+    const float panelX = width - panelWidth - 10;
+    
+    renderer->setDrawColor(0, 0, 0, 160);
+    renderer->drawFillRect(panelX, 70, panelWidth, lineHeight * (zones.size() + 3) + 10);
     
-    // Draw instructions - centered
-    renderer->drawTextCentered("pixel_medium", "Press SPACE or ENTER to Start", height/2 + 20, 200, 200, 200);
-    renderer->drawTextCentered("pixel_small", "Use A/D to move, SPACE to shoot", height/2 + 60, 180, 180, 180);
-    renderer->drawTextCentered("pixel_small", "Press ESC to pause during game", height/2 + 90, 180, 180, 180);
+    char line[96];
+    float y = 75;
+    std::snprintf(line, sizeof(line), "frame p50 %.2f p95 %.2f p99 %.2f", summary.p50, summary.p95, summary.p99);
+    renderer->drawText("pixel_small", line, panelX + 5, y, 255, 255, 0);
+    y += lineHeight;
+    std::snprintf(line, sizeof(line), "max %.2f ms over %zu frames", summary.max, summary.frames);
+    renderer->drawText("pixel_small", line, panelX + 5, y, 255, 255, 0);
+    y += lineHeight;
+    const Renderer::FrameStats& stats = renderer->getFrameStats();
+    std::snprintf(line, sizeof(line), "draws %d sprites %d layers redrawn %d", stats.drawCalls, stats.sprites,
+                  stats.layerRebuilds);
+    renderer->drawText("pixel_small", line, panelX + 5, y, 255, 255, 0);
+    y += lineHeight;
+    for (const auto& zone : zones) {
+        std::snprintf(line, sizeof(line), "%-16s %6.3f ms x%d", zone.name, zone.milliseconds, zone.calls);
+        renderer->drawText("pixel_small", line, panelX + 5, y, 255, 255, 255);
+        y += lineHeight;
+    }
 }
 
 void Game::renderPaused() {
-    // Draw semi-transparent overlay
-    renderer->setDrawColor(0, 0, 0, 128);
-    renderer->drawFillRect(0, 0, width, height);
+    // Redrawn once fonts arrive, since the text is skipped until then
+    renderer->updateLayer(pausedLayer, assetLoader->areFontsReady(), [this] {
+        // Draw semi-transparent overlay
+        renderer->setDrawColor(0, 0, 0, 128);
+        renderer->drawFillRect(0, 0, width, height);
     
-    // Draw pause text - centered
-    renderer->drawTextCentered("pixel_large", "PAUSED", height/2 - 30, 255, 255, 255);
-    renderer->drawTextCentered("pixel_medium", "Press ESC to Resume", height/2 + 20, 200, 200, 200);
+        // Draw pause text - centered
+        renderer->drawTextCentered("pixel_large", "PAUSED", height/2 - 30, 255, 255, 255);
+        renderer->drawTextCentered("pixel_medium", "Press ESC to Resume", height/2 + 20, 200, 200, 200);
+    });
+    renderer->compositeLayer(pausedLayer, 0, 0);
 }
 
-void Game::renderGameOver() {
-    // Draw semi-transparent overlay
-    renderer->setDrawColor(0, 0, 0, 128);
-    renderer->drawFillRect(0, 0, width, height);
+void Game::renderGameOver(const SimSnapshot& snapshot) {
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(snapshot.score)) << 1) | assetLoader->areFontsReady();
+    renderer->updateLayer(gameOverLayer, key, [this, score = snapshot.score] {
+        // Draw semi-transparent overlay
+        renderer->setDrawColor(0, 0, 0, 128);
+        renderer->drawFillRect(0, 0, width, height);
     
-    // Draw game over text - centered
-    renderer->drawTextCentered("pixel_large", "GAME OVER", height/2 - 50, 255, 0, 0);
+        // Draw game over text - centered
+        renderer->drawTextCentered("pixel_large", "GAME OVER", height/2 - 50, 255, 0, 0);
     
-    // Draw final score - centered
-    std::string scoreText = "Final Score: " + std::to_string(score);
-    renderer->drawTextCentered("pixel_medium", scoreText, height/2 + 10, 255, 255, 255);
+        // Draw final score - centered, from the glyph atlas as it changes
+        // every game and would only churn the text cache
+        std::string_view scoreText = renderer->getFrameArena().format("Final Score: %d", score);
+        float scoreX = (width - renderer->getTextWidth("pixel_medium", scoreText)) / 2.0f;
+        renderer->drawText("pixel_medium", scoreText, scoreX, height/2 + 10, 255, 255, 255);
     
-    // Draw restart instruction - centered
-    renderer->drawTextCentered("pixel_medium", "Press SPACE to Return to Menu", height/2 + 50, 200, 200, 200);
+        // Draw restart instruction - centered
+        renderer->drawTextCentered("pixel_medium", "Press SPACE to Return to Menu", height/2 + 50, 200, 200, 200);
+    });
+    renderer->compositeLayer(gameOverLayer, 0, 0);
 }
 
 // Particle system
-void Game::addParticle(float x, float y, float vx, float vy, Uint8 r, Uint8 g, Uint8 b, int life) {
-    Particle p;
-    p.x = x;
-    p.y = y;
-    p.vx = vx;
-    p.vy = vy;
-    p.r = r;
-    p.g = g;
-    p.b = b;
-    p.life = life;
-    particles.push_back(p);
+void Game::renderParticles(const SimSnapshot& snapshot, float alpha) {
+    // Particles move by their velocity every tick, so the previous position is one step back
+    const SimSnapshot::Particles& particles = snapshot.particles;
+    renderer->drawParticles(particles.x.data(), particles.y.data(), particles.vx.data(), particles.vy.data(),
+                            particles.color.data(), particles.size(), 4, alpha - 1.0f);
 }
-
-void Game::updateParticles() {
-    for (auto it = particles.begin(); it != particles.end();) {
-        it->x += it->vx;
-        it->y += it->vy;
-        it->life--;
-        
-        if (it->life <= 0) {
-            it = particles.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void Game::renderParticles() {
-    for (const auto& p : particles) {
-        renderer->setDrawColor(p.r, p.g, p.b);
-        renderer->drawFillRect(p.x - 2, p.y - 2, 4, 4);
-    }
-}
-
-// Enhanced collision detection
-void Game::removeOffScreenBullets() {
-    bullets.erase(std::remove_if(bullets.begin(), bullets.end(),
-                                [this](Bullet &b){ 
-                                    return b.y < 0; // Remove bullets that have gone off the top
-                                }),
-                bullets.end());
-}
-
-void Game::createHitEffect(int x, int y) {
-    float pixelX = gameToPixelX(x) + TILE_SIZE/2;
-    float pixelY = gameToPixelY(y) + TILE_SIZE/2;
-    
-    // Create explosion particles
-    for (int i = 0; i < 8; i++) {
-        float angle = (i * 45.0f) * 3.14159f / 180.0f;
-        float speed = 2.0f + (rand() % 3);
-        float vx = cos(angle) * speed;
-        float vy = sin(angle) * speed;
-        
-        Uint8 r = 255;
-        Uint8 g = 100 + (rand() % 155);
-        Uint8 b = 0;
-        
-        addParticle(pixelX, pixelY, vx, vy, r, g, b, 20 + (rand() % 20));
-    }
-}
\ No newline at end of file
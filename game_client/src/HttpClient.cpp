@@ -0,0 +1,146 @@
+#include "../include/HttpClient.h"
+#include "../include/Sockets.h"
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using namespace sockets;
+using Clock = std::chrono::steady_clock;
+
+// Waits for events on s until the deadline; false on timeout or error
+bool waitFor(Socket s, short events, Clock::time_point deadline) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    if (remaining <= 0) return false;
+    pollfd entry = {};
+    entry.fd = s;
+    entry.events = events;
+    return pollSockets(&entry, 1, static_cast<int>(remaining)) == 1 && (entry.revents & (events | POLLHUP));
+}
+
+Socket connectTo(const HttpUrl& url, Clock::time_point deadline, std::string& error) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(url.host.c_str(), url.port.c_str(), &hints, &addresses) != 0) {
+        error = "cannot resolve " + url.host;
+        return NO_SOCKET;
+    }
+
+    Socket result = NO_SOCKET;
+    error = "cannot connect to " + url.host + ":" + url.port;
+    for (addrinfo* address = addresses; address && result == NO_SOCKET; address = address->ai_next) {
+        Socket s = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (s == NO_SOCKET) continue;
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        if (setNonBlocking(s) &&
+            (connect(s, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 ||
+             (connectPending() && waitFor(s, POLLOUT, deadline)))) {
+            int socketError = 0;
+            socklen_t length = sizeof(socketError);
+            getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&socketError), &length);
+            if (socketError == 0) {
+                result = s;
+                continue;
+            }
+        }
+        closeSocket(s);
+    }
+    freeaddrinfo(addresses);
+    return result;
+}
+
+bool sendAll(Socket s, const char* data, size_t size, Clock::time_point deadline) {
+    while (size > 0) {
+        if (!waitFor(s, POLLOUT, deadline)) return false;
+        auto sent = send(s, data, static_cast<int>(size), SEND_FLAGS);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+}
+
+bool HttpUrl::parse(const std::string& url) {
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0) return false;
+    size_t hostStart = scheme.size();
+    size_t pathStart = url.find('/', hostStart);
+    std::string authority = url.substr(hostStart, pathStart - hostStart);
+    path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos && authority.find(']', colon) == std::string::npos) {
+        host = authority.substr(0, colon);
+        port = authority.substr(colon + 1);
+    } else {
+        host = authority;
+        port = "80";
+    }
+    // Bracketed IPv6 literals
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    return !host.empty() && !port.empty();
+}
+
+HttpResponse httpPost(const HttpUrl& url, const HttpHeaders& headers, const void* body, size_t size, int timeoutMs) {
+    HttpResponse response;
+    if (!startNetworking()) {
+        response.error = "networking unavailable";
+        return response;
+    }
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    Socket s = connectTo(url, deadline, response.error);
+    if (s == NO_SOCKET) return response;
+
+    std::string request = "POST " + url.path + " HTTP/1.1\r\nHost: " + url.host + "\r\nConnection: close\r\n" +
+                          "Content-Length: " + std::to_string(size) + "\r\n";
+    for (const auto& header : headers) {
+        request += header.first + ": " + header.second + "\r\n";
+    }
+    request += "\r\n";
+
+    // Only the status line and headers are read; the body is not needed
+    std::string received;
+    if (sendAll(s, request.data(), request.size(), deadline) &&
+        sendAll(s, static_cast<const char*>(body), size, deadline)) {
+        char buffer[1024];
+        while (received.find("\r\n\r\n") == std::string::npos && received.size() < 16384) {
+            if (!waitFor(s, POLLIN, deadline)) break;
+            auto count = recv(s, buffer, sizeof(buffer), 0);
+            if (count <= 0) break;
+            received.append(buffer, count);
+        }
+    }
+    closeSocket(s);
+
+    size_t headerEnd = received.find("\r\n\r\n");
+    if (received.compare(0, 5, "HTTP/") != 0 || headerEnd == std::string::npos) {
+        response.error = received.empty() ? "no response before timeout" : "malformed response";
+        return response;
+    }
+    size_t space = received.find(' ');
+    response.status = std::atoi(received.c_str() + space + 1);
+
+    for (size_t line = received.find("\r\n") + 2; line < headerEnd;) {
+        size_t next = received.find("\r\n", line);
+        std::string field = received.substr(line, next - line);
+        const char* name = "retry-after:";
+        if (field.size() > std::strlen(name)) {
+            bool match = true;
+            for (size_t i = 0; name[i] && match; i++) {
+                match = std::tolower(static_cast<unsigned char>(field[i])) == name[i];
+            }
+            if (match) response.retryAfterSeconds = std::atoi(field.c_str() + std::strlen(name));
+        }
+        line = next + 2;
+    }
+    return response;
+}
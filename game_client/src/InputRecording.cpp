@@ -0,0 +1,151 @@
+#include "../include/InputRecording.h"
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+InputRecorder::~InputRecorder() {
+    // Without a simulation to hash, a log closed here just ends unterminated
+    if (out.is_open()) out.close();
+}
+
+bool InputRecorder::open(const std::string& path, const Simulation& sim) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error opening recording " << path << std::endl;
+        return false;
+    }
+
+    recording::RecordingHeader header = {};
+    std::memcpy(header.magic, recording::MAGIC, 4);
+    header.version = recording::VERSION;
+    header.seed = sim.getSeed();
+    header.width = static_cast<uint16_t>(sim.getWidth());
+    header.height = static_cast<uint16_t>(sim.getHeight());
+    header.hashInterval = recording::HASH_INTERVAL;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    updates = 0;
+    lastRecord = 0;
+    actions = 0;
+    return static_cast<bool>(out);
+}
+
+void InputRecorder::writeRecord(uint8_t tag) {
+    // LEB128 varint: mostly a single byte, as records are only ticks apart
+    uint64_t delta = updates - lastRecord;
+    while (delta >= 0x80) {
+        out.put(static_cast<char>((delta & 0x7f) | 0x80));
+        delta >>= 7;
+    }
+    out.put(static_cast<char>(delta));
+    out.put(static_cast<char>(tag));
+    lastRecord = updates;
+}
+
+void InputRecorder::recordAction(Simulation::Action action) {
+    if (!out.is_open()) return;
+    writeRecord(static_cast<uint8_t>(action));
+    actions++;
+}
+
+void InputRecorder::recordUpdate(const Simulation& sim) {
+    if (!out.is_open()) return;
+    updates++;
+    if (updates % recording::HASH_INTERVAL == 0) {
+        writeRecord(recording::TAG_HASH);
+        uint64_t hash = sim.stateHash();
+        out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    }
+}
+
+bool InputRecorder::close(const Simulation& sim) {
+    if (!out.is_open()) return false;
+    writeRecord(recording::TAG_HASH);
+    uint64_t hash = sim.stateHash();
+    out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    writeRecord(recording::TAG_END);
+    out.close();
+    if (!out) {
+        std::cerr << "Error writing recording" << std::endl;
+        return false;
+    }
+    std::cout << "Recorded " << actions << " actions over " << updates << " updates" << std::endl;
+    return true;
+}
+
+bool InputReplay::open(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Error opening recording " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data(std::istreambuf_iterator<char>(in), {});
+    if (const char* error = load(data.data(), data.size())) {
+        std::cerr << error << ": " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* InputReplay::load(const uint8_t* data, size_t size) {
+    if (size < sizeof(header)) return "Not a recording";
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, recording::MAGIC, 4) != 0) return "Not a recording";
+    if (header.version != recording::VERSION) return "Unsupported recording version";
+    body.assign(data + sizeof(header), data + size);
+    return nullptr;
+}
+
+InputReplay::Result InputReplay::run(Simulation& sim, uint64_t maxUpdates) const {
+    Result result;
+    size_t pos = 0;
+    uint64_t lastRecord = 0;
+
+    while (pos < body.size()) {
+        uint64_t delta = 0;
+        int shift = 0;
+        while (pos < body.size() && (body[pos] & 0x80)) {
+            delta |= static_cast<uint64_t>(body[pos++] & 0x7f) << shift;
+            shift += 7;
+            if (shift >= 64) {
+                result.malformed = true;
+                return result;
+            }
+        }
+        if (pos + 1 >= body.size()) break; // Truncated record
+        delta |= static_cast<uint64_t>(body[pos++]) << shift;
+        uint8_t tag = body[pos++];
+
+        lastRecord += delta;
+        if (lastRecord > maxUpdates || lastRecord < delta) {
+            result.overLimit = true;
+            break;
+        }
+        while (result.updates < lastRecord) {
+            sim.update();
+            result.updates++;
+        }
+
+        if (tag == recording::TAG_END) {
+            result.complete = true;
+            break;
+        } else if (tag == recording::TAG_HASH) {
+            uint64_t hash;
+            if (pos + sizeof(hash) > body.size()) break;
+            std::memcpy(&hash, &body[pos], sizeof(hash));
+            pos += sizeof(hash);
+            result.hashesChecked++;
+            if (hash != sim.stateHash()) {
+                result.mismatchAt = static_cast<int64_t>(result.updates);
+                break;
+            }
+        } else if (tag <= static_cast<uint8_t>(Simulation::Action::MOVE_RIGHT)) {
+            sim.applyAction(static_cast<Simulation::Action>(tag));
+            result.actions++;
+        } else {
+            result.malformed = true;
+            break;
+        }
+    }
+    return result;
+}
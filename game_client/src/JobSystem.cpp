@@ -0,0 +1,93 @@
+#include "../include/JobSystem.h"
+
+JobSystem::JobSystem(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::dispatch(void (*run)(void*, size_t, size_t), void* context, size_t count, size_t grain) {
+    size_t chunks = (count + grain - 1) / grain;
+    size_t threads = queues.size();
+    remaining.store(chunks, std::memory_order_relaxed);
+
+    // Contiguous blocks of chunks per thread keep neighbouring data together
+    for (size_t t = 0; t < threads; t++) {
+        size_t first = chunks * t / threads;
+        size_t last = chunks * (t + 1) / threads;
+        std::lock_guard<std::mutex> lock(queues[t]->mutex);
+        for (size_t c = first; c < last; c++) {
+            queues[t]->tasks.push_back({run, context, c * grain, std::min(count, (c + 1) * grain)});
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        epoch++;
+    }
+    wakeWorkers.notify_all();
+
+    // Help until every chunk has finished, including ones stolen by workers
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!runOne(0)) std::this_thread::yield();
+    }
+}
+
+bool JobSystem::runOne(size_t self) {
+    Task task;
+    bool found = false;
+    {
+        // Own work newest first
+        std::lock_guard<std::mutex> lock(queues[self]->mutex);
+        if (!queues[self]->tasks.empty()) {
+            task = queues[self]->tasks.back();
+            queues[self]->tasks.pop_back();
+            found = true;
+        }
+    }
+    for (size_t offset = 1; !found && offset < queues.size(); offset++) {
+        // Steal the oldest chunk from the next thread that has any
+        TaskQueue& victim = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    task.run(task.context, task.begin, task.end);
+    remaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void JobSystem::workerLoop(size_t self) {
+    while (true) {
+        uint64_t seen;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            if (stopping) return;
+            seen = epoch;
+        }
+        while (runOne(self)) {}
+
+        // Sleep until the next parallelFor; one taken since 'seen' means there is work
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeWorkers.wait(lock, [this, seen] { return stopping || epoch != seen; });
+    }
+}
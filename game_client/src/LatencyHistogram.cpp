@@ -0,0 +1,33 @@
+#include "../include/LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+void LatencyHistogram::add(double ms) {
+    // Bucket i holds (MIN_MS * 2^((i - 1) / 16), MIN_MS * 2^(i / 16)]
+    int bucket = 0;
+    if (ms > MIN_MS) {
+        double step = std::ceil(std::log2(ms / MIN_MS) * STEPS_PER_DOUBLING);
+        bucket = static_cast<int>(std::min<double>(step, BUCKETS - 1));
+    }
+    buckets[bucket]++;
+    total++;
+    largest = std::max(largest, ms);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKETS; i++) buckets[i] += other.buckets[i];
+    total += other.total;
+    largest = std::max(largest, other.largest);
+}
+
+double LatencyHistogram::percentile(double q) const {
+    if (total == 0) return 0;
+    // The same rank a sorted vector would be indexed at
+    uint64_t rank = static_cast<uint64_t>((total - 1) * q);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > rank) return std::min(largest, MIN_MS * std::exp2(double(i) / STEPS_PER_DOUBLING));
+    }
+    return largest;
+}
@@ -0,0 +1,18 @@
+#include "../include/LatencyTracker.h"
+#include <algorithm>
+
+void LatencyTracker::inputQueued(uint32_t sequence, int64_t inputTime) {
+    pending.push_back({sequence, inputTime});
+}
+
+void LatencyTracker::framePresented(uint32_t appliedSequence, int64_t presentTime) {
+    while (!pending.empty() && pending.front().sequence <= appliedSequence) {
+        samples.add(std::max<int64_t>(presentTime - pending.front().inputTime, 0) / 1e6);
+        pending.pop_front();
+    }
+}
+
+LatencyTracker::Summary LatencyTracker::summary() const {
+    return {samples.percentile(0.50), samples.percentile(0.95), samples.percentile(0.99), samples.max(),
+            samples.count()};
+}
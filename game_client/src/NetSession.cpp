@@ -0,0 +1,483 @@
+#include "../include/NetSession.h"
+#include "../include/Profiler.h"
+#include "../include/StateSnapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename T>
+void fillHeader(T& packet, net::PacketType type) {
+    std::memcpy(packet.header.magic, net::MAGIC, 4);
+    packet.header.version = net::VERSION;
+    packet.header.type = type;
+    packet.header.reserved = 0;
+}
+
+// Copies the packet's leading T; false if the packet is shorter
+template <typename T>
+bool readPacket(const uint8_t* data, size_t size, T& out) {
+    if (size < sizeof(T)) return false;
+    std::memcpy(&out, data, sizeof(T));
+    return true;
+}
+
+int64_t nowNs() {
+    return Clock::now().time_since_epoch().count();
+}
+
+bool isAction(uint8_t value) {
+    return value <= static_cast<uint8_t>(Simulation::Action::MOVE_RIGHT);
+}
+
+bool isMove(Simulation::Action action) {
+    return action == Simulation::Action::MOVE_LEFT || action == Simulation::Action::MOVE_RIGHT;
+}
+
+}
+
+NetHost::NetHost(int bytesPerSecond) : bytesPerSecond(bytesPerSecond) {}
+
+bool NetHost::open(uint16_t port) {
+    if (!socket.open(port)) return false;
+    std::cout << "Hosting on UDP port " << socket.getPort() << std::endl;
+    return true;
+}
+
+bool NetHost::poll(Simulation& sim) {
+    PROFILE_ZONE("netHostPoll");
+    bool changed = false;
+    uint8_t buffer[net::MAX_PACKET];
+    NetAddress from;
+    int size;
+    while ((size = socket.receive(from, buffer, sizeof(buffer))) >= 0) {
+        net::PacketHeader header;
+        if (!readPacket(buffer, size, header) || std::memcmp(header.magic, net::MAGIC, 4) != 0 ||
+            header.version != net::VERSION) {
+            continue;
+        }
+        if (header.type == net::CONNECT) {
+            size_t before = clients.size();
+            handleConnect(sim, from, buffer, size);
+            changed |= clients.size() != before;
+            continue;
+        }
+
+        auto client = std::find_if(clients.begin(), clients.end(), [&](const Client& c) { return c.address == from; });
+        if (client == clients.end()) continue;
+        if (header.type == net::INPUT) {
+            changed |= handleInput(sim, *client, buffer, size);
+        } else if (header.type == net::DISCONNECT) {
+            net::ConnectPacket packet;
+            if (readPacket(buffer, size, packet) && packet.nonce == client->nonce) {
+                std::cout << "Player " << client->player << " left" << std::endl;
+                sim.removePlayer(client->player);
+                clients.erase(client);
+                changed = true;
+            }
+        }
+    }
+
+    auto now = Clock::now();
+    for (auto client = clients.begin(); client != clients.end();) {
+        if (now - client->lastHeard > std::chrono::milliseconds(net::TIMEOUT_MS)) {
+            std::cout << "Player " << client->player << " timed out" << std::endl;
+            sim.removePlayer(client->player);
+            client = clients.erase(client);
+            changed = true;
+        } else {
+            ++client;
+        }
+    }
+    return changed;
+}
+
+void NetHost::handleConnect(Simulation& sim, const NetAddress& from, const uint8_t* data, size_t size) {
+    net::ConnectPacket request;
+    if (!readPacket(data, size, request)) return;
+
+    auto existing = std::find_if(clients.begin(), clients.end(), [&](const Client& c) { return c.address == from; });
+    if (existing != clients.end() && existing->nonce != request.nonce) {
+        // The same port again with a new session: the old one is gone
+        sim.removePlayer(existing->player);
+        clients.erase(existing);
+        existing = clients.end();
+    }
+
+    int player = existing != clients.end() ? existing->player : -1;
+    if (player < 0 && request.width == sim.getWidth() && request.height == sim.getHeight()) {
+        player = sim.addPlayer();
+    }
+    if (player < 0) {
+        net::ConnectPacket reject = {};
+        fillHeader(reject, net::REJECT);
+        reject.nonce = request.nonce;
+        socket.send(from, &reject, sizeof(reject));
+        return;
+    }
+
+    if (existing == clients.end()) {
+        Client client;
+        client.address = from;
+        client.nonce = request.nonce;
+        client.player = player;
+        client.lastHeard = client.tokensAt = Clock::now();
+        client.tokens = bytesPerSecond;
+        clients.push_back(client);
+        std::cout << "Player " << player << " joined from " << from.toString() << std::endl;
+    }
+
+    // Sent again for every repeated request, in case the first was lost
+    net::WelcomePacket welcome = {};
+    fillHeader(welcome, net::WELCOME);
+    welcome.nonce = request.nonce;
+    welcome.player = static_cast<uint8_t>(player);
+    socket.send(from, &welcome, sizeof(welcome));
+}
+
+bool NetHost::handleInput(Simulation& sim, Client& client, const uint8_t* data, size_t size) {
+    net::InputPacket input;
+    if (!readPacket(data, size, input) || input.nonce != client.nonce || input.count > net::MAX_INPUTS ||
+        size != sizeof(input) + input.count) {
+        return false;
+    }
+    auto now = Clock::now();
+    client.lastHeard = now;
+    if (input.ackFrame > client.ackFrame && input.ackFrame <= frame) client.ackFrame = input.ackFrame;
+    if (input.sentAt > client.echoSentAt) {
+        client.echoSentAt = input.sentAt;
+        client.echoReceived = now;
+    }
+
+    // Actions repeat until acknowledged; only the new ones apply
+    bool changed = false;
+    const uint8_t* actions = data + sizeof(input);
+    for (uint32_t i = 0; i < input.count; i++) {
+        uint32_t sequence = input.firstSequence + i;
+        if (sequence <= client.lastSequence || !isAction(actions[i])) continue;
+        sim.applyAction(static_cast<Simulation::Action>(actions[i]), client.player);
+        client.lastSequence = sequence;
+        changed = true;
+    }
+    return changed;
+}
+
+void NetHost::afterUpdate(const Simulation& sim) {
+    PROFILE_ZONE("netHostSend");
+    frame++;
+    Frame& current = frames[frame % net::FRAME_HISTORY];
+    current.frame = frame;
+    encodeSnapshot(sim, current.bytes);
+    counters.frames++;
+
+    for (Client& client : clients) {
+        sendFrame(client, sim);
+    }
+}
+
+void NetHost::sendFrame(Client& client, const Simulation& sim) {
+    // Token bucket: a second's budget at most, refilled continuously
+    auto now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - client.tokensAt).count();
+    client.tokens = std::min<double>(bytesPerSecond, client.tokens + elapsed * bytesPerSecond);
+    client.tokensAt = now;
+    if (client.tokens <= 0) {
+        counters.throttledFrames++;
+        return;
+    }
+
+    const Frame& current = frames[frame % net::FRAME_HISTORY];
+    const auto& hits = sim.getTickHits();
+    uint16_t hitCount = static_cast<uint16_t>(std::min<size_t>(hits.size(), 0xffff));
+    payload.clear();
+    payload.insert(payload.end(), reinterpret_cast<const uint8_t*>(&hitCount),
+                   reinterpret_cast<const uint8_t*>(&hitCount) + sizeof(hitCount));
+    for (size_t i = 0; i < hitCount; i++) {
+        int16_t position[2] = {hits[i].first, hits[i].second};
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(position);
+        payload.insert(payload.end(), bytes, bytes + sizeof(position));
+    }
+
+    // A delta needs a base the client has acknowledged and the host still holds
+    uint32_t baseFrame = client.ackFrame;
+    const Frame& base = frames[baseFrame % net::FRAME_HISTORY];
+    SnapshotView from, to;
+    if (baseFrame != 0 && base.frame == baseFrame && from.open(base.bytes.data(), base.bytes.size()) &&
+        to.open(current.bytes.data(), current.bytes.size())) {
+        encodeDelta(from, to, delta);
+        payload.insert(payload.end(), delta.begin(), delta.end());
+    } else {
+        baseFrame = 0;
+        payload.insert(payload.end(), current.bytes.begin(), current.bytes.end());
+        counters.fullFrames++;
+    }
+    if (payload.size() > net::MAX_FRAME) {
+        std::cerr << "Frame of " << payload.size() << " bytes is too large to send" << std::endl;
+        return;
+    }
+
+    net::StatePacket state = {};
+    fillHeader(state, net::STATE);
+    state.frame = frame;
+    state.baseFrame = baseFrame;
+    state.inputAck = client.lastSequence;
+    if (client.echoSentAt != 0) {
+        state.echoSentAt = client.echoSentAt;
+        state.echoHeldUs = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - client.echoReceived).count());
+    }
+    state.size = static_cast<uint32_t>(payload.size());
+    state.fragments = static_cast<uint16_t>((payload.size() + net::MAX_FRAGMENT - 1) / net::MAX_FRAGMENT);
+    for (uint16_t i = 0; i < state.fragments; i++) {
+        size_t offset = size_t(i) * net::MAX_FRAGMENT;
+        size_t length = std::min(net::MAX_FRAGMENT, payload.size() - offset);
+        state.fragment = i;
+        packet.resize(sizeof(state) + length);
+        std::memcpy(packet.data(), &state, sizeof(state));
+        std::memcpy(packet.data() + sizeof(state), payload.data() + offset, length);
+        socket.send(client.address, packet.data(), packet.size());
+        client.tokens -= packet.size();
+        counters.bytesSent += packet.size();
+    }
+    counters.framesSent++;
+}
+
+NetHost::Stats NetHost::stats() const {
+    Stats result = counters;
+    result.clients = static_cast<int>(clients.size());
+    return result;
+}
+
+const std::vector<uint8_t>* NetHost::stateAt(uint32_t target) const {
+    const Frame& slot = frames[target % net::FRAME_HISTORY];
+    return target != 0 && slot.frame == target ? &slot.bytes : nullptr;
+}
+
+NetClient::NetClient(int width, int height) : sim(width, height, 0) {}
+
+bool NetClient::connect(const NetAddress& address, int timeoutMs) {
+    if (!socket.isOpen() && !socket.open(0)) return false;
+    host = address;
+    nonce = (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}() ^ uint64_t(nowNs());
+
+    net::ConnectPacket request = {};
+    fillHeader(request, net::CONNECT);
+    request.nonce = nonce;
+    request.width = sim.getWidth();
+    request.height = sim.getHeight();
+
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    auto resendAt = Clock::now();
+    while (Clock::now() < deadline) {
+        if (Clock::now() >= resendAt) {
+            socket.send(host, &request, sizeof(request));
+            resendAt = Clock::now() + std::chrono::milliseconds(250);
+        }
+        socket.wait(10);
+
+        uint8_t buffer[net::MAX_PACKET];
+        NetAddress from;
+        int size;
+        while ((size = socket.receive(from, buffer, sizeof(buffer))) >= 0) {
+            net::WelcomePacket welcome;
+            if (!(from == host) || !readPacket(buffer, size, welcome) ||
+                std::memcmp(welcome.header.magic, net::MAGIC, 4) != 0 || welcome.nonce != nonce) {
+                continue;
+            }
+            if (welcome.header.type == net::REJECT) {
+                std::cerr << "Host " << host.toString() << " refused: game full or a different window size" << std::endl;
+                return false;
+            }
+            if (welcome.header.type == net::WELCOME) {
+                player = welcome.player;
+                connected = true;
+                lastFrameAt = lastSent = Clock::now();
+                std::cout << "Joined " << host.toString() << " as player " << player << std::endl;
+                return true;
+            }
+        }
+    }
+    std::cerr << "No answer from " << host.toString() << std::endl;
+    return false;
+}
+
+void NetClient::disconnect() {
+    if (!connected) return;
+    net::ConnectPacket bye = {};
+    fillHeader(bye, net::DISCONNECT);
+    bye.nonce = nonce;
+    // Unacknowledged, so sent a few times; the host times out the rest
+    for (int i = 0; i < 3; i++) socket.send(host, &bye, sizeof(bye));
+    connected = false;
+}
+
+void NetClient::sendAction(Simulation::Action action) {
+    if (!connected) return;
+    if (pending.size() == 256) pending.erase(pending.begin());
+    pending.push_back({nextSequence++, action, nowNs()});
+    counters.actionsSent++;
+    // Prediction: the own ship moves now rather than a round trip later
+    if (isMove(action) && sim.getGameState() == Simulation::PLAYING) sim.applyAction(action, player);
+    sendInputs();
+}
+
+void NetClient::sendInputs() {
+    uint8_t buffer[sizeof(net::InputPacket) + net::MAX_INPUTS];
+    net::InputPacket input = {};
+    fillHeader(input, net::INPUT);
+    input.nonce = nonce;
+    input.ackFrame = frame;
+    input.firstSequence = pending.empty() ? nextSequence : pending.front().sequence;
+    input.sentAt = nowNs();
+    input.count = static_cast<uint8_t>(std::min<size_t>(pending.size(), net::MAX_INPUTS));
+    std::memcpy(buffer, &input, sizeof(input));
+    for (uint8_t i = 0; i < input.count; i++) {
+        buffer[sizeof(input) + i] = static_cast<uint8_t>(pending[i].action);
+    }
+    socket.send(host, buffer, sizeof(input) + input.count);
+    lastSent = Clock::now();
+}
+
+bool NetClient::poll() {
+    PROFILE_ZONE("netClientPoll");
+    if (!connected) return false;
+    bool applied = false;
+    uint8_t buffer[net::MAX_PACKET];
+    NetAddress from;
+    int size;
+    while ((size = socket.receive(from, buffer, sizeof(buffer))) >= 0) {
+        if (from == host) applied |= handleState(buffer, size);
+    }
+
+    auto now = Clock::now();
+    if (now - lastFrameAt > std::chrono::milliseconds(net::TIMEOUT_MS)) {
+        std::cerr << "Lost connection to " << host.toString() << std::endl;
+        connected = false;
+        return applied;
+    }
+    // Acknowledge new frames at once; otherwise keep the host hearing from us
+    if (applied || now - lastSent > std::chrono::milliseconds(100)) sendInputs();
+    return applied;
+}
+
+bool NetClient::handleState(const uint8_t* data, size_t size) {
+    net::StatePacket state;
+    if (!readPacket(data, size, state) || std::memcmp(state.header.magic, net::MAGIC, 4) != 0 ||
+        state.header.version != net::VERSION || state.header.type != net::STATE || state.fragments == 0 ||
+        state.fragment >= state.fragments || state.size > net::MAX_FRAME ||
+        state.fragments != (state.size + net::MAX_FRAGMENT - 1) / net::MAX_FRAGMENT) {
+        return false;
+    }
+    size_t offset = size_t(state.fragment) * net::MAX_FRAGMENT;
+    size_t length = std::min<size_t>(net::MAX_FRAGMENT, state.size - offset);
+    if (size != sizeof(state) + length) return false;
+
+    if (state.fragment == 0 && state.echoSentAt != 0) {
+        double roundTrip = (nowNs() - state.echoSentAt) / 1e6 - state.echoHeldUs / 1e3;
+        counters.roundTripMs.add(std::max(0.0, roundTrip));
+    }
+
+    // Only the newest frame is assembled; anything older is superseded
+    if (state.frame <= frame || state.frame < assembly.frame) return false;
+    if (state.frame > assembly.frame) {
+        if (assembly.frame != 0 && assembly.received < assembly.fragments) counters.framesDropped++;
+        assembly.frame = state.frame;
+        assembly.baseFrame = state.baseFrame;
+        assembly.fragments = state.fragments;
+        assembly.received = 0;
+        assembly.inputAck = state.inputAck;
+        assembly.have.assign(state.fragments, 0);
+        assembly.bytes.resize(state.size);
+    }
+    if (assembly.baseFrame != state.baseFrame || assembly.bytes.size() != state.size ||
+        assembly.have[state.fragment]) {
+        return false;
+    }
+    assembly.have[state.fragment] = 1;
+    std::memcpy(assembly.bytes.data() + offset, data + sizeof(state), length);
+    if (++assembly.received < assembly.fragments) return false;
+    return applyFrame();
+}
+
+bool NetClient::applyFrame() {
+    PROFILE_ZONE("netClientApply");
+    const std::vector<uint8_t>& payload = assembly.bytes;
+    uint16_t hitCount = 0;
+    if (payload.size() >= sizeof(hitCount)) std::memcpy(&hitCount, payload.data(), sizeof(hitCount));
+    size_t bodyOffset = sizeof(hitCount) + size_t(hitCount) * 2 * sizeof(int16_t);
+    if (payload.size() < bodyOffset) {
+        counters.framesDropped++;
+        return false;
+    }
+    const uint8_t* body = payload.data() + bodyOffset;
+    size_t bodySize = payload.size() - bodyOffset;
+
+    if (assembly.baseFrame == 0) {
+        decoded.assign(body, body + bodySize);
+    } else {
+        const Frame& base = frames[assembly.baseFrame % net::FRAME_HISTORY];
+        SnapshotView baseView;
+        if (base.frame != assembly.baseFrame || !baseView.open(base.bytes.data(), base.bytes.size()) ||
+            !applyDelta(baseView, body, bodySize, decoded)) {
+            counters.framesDropped++;
+            return false;
+        }
+    }
+
+    SnapshotView view;
+    bool predicted = player < sim.getPlayerCount();
+    int predictedX = predicted ? sim.getPlayer(player).x : 0;
+    if (!view.open(decoded.data(), decoded.size()) || !sim.restore(view, true)) {
+        counters.framesDropped++;
+        return false;
+    }
+    Frame& slot = frames[assembly.frame % net::FRAME_HISTORY];
+    slot.frame = assembly.frame;
+    slot.bytes.swap(decoded);
+
+    if (player >= sim.getPlayerCount() || !sim.getPlayer(player).active) {
+        std::cerr << "Removed from the game by the host" << std::endl;
+        connected = false;
+        return false;
+    }
+
+    // The host's particles are not sent, only the hits that start them
+    for (uint16_t i = 0; i < hitCount; i++) {
+        int16_t position[2];
+        std::memcpy(position, payload.data() + sizeof(hitCount) + i * sizeof(position), sizeof(position));
+        sim.emitHitEffect(position[0], position[1]);
+    }
+    sim.updateEffects();
+
+    // Reconcile: drop the actions the frame includes, then replay the moves
+    // it does not yet include on top of it
+    int64_t now = nowNs();
+    size_t acknowledged = 0;
+    while (acknowledged < pending.size() && pending[acknowledged].sequence <= assembly.inputAck) {
+        counters.inputLatencyMs.add((now - pending[acknowledged].sentAt) / 1e6);
+        acknowledged++;
+    }
+    pending.erase(pending.begin(), pending.begin() + acknowledged);
+    if (sim.getGameState() == Simulation::PLAYING) {
+        for (const Pending& input : pending) {
+            if (isMove(input.action)) sim.applyAction(input.action, player);
+        }
+    }
+    if (predicted && sim.getPlayer(player).x != predictedX) counters.corrections++;
+
+    if (frame != 0) counters.framesSkipped += assembly.frame - frame - 1;
+    frame = assembly.frame;
+    frameTime = now;
+    lastFrameAt = Clock::now();
+    counters.frames++;
+    return true;
+}
+
+const std::vector<uint8_t>* NetClient::stateAt(uint32_t target) const {
+    const Frame& slot = frames[target % net::FRAME_HISTORY];
+    return target != 0 && slot.frame == target ? &slot.bytes : nullptr;
+}
@@ -0,0 +1,145 @@
+#include "../include/NetSocket.h"
+#include "../include/Sockets.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace sockets;
+
+namespace {
+
+sockaddr_in toSockaddr(const NetAddress& address) {
+    sockaddr_in result = {};
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(address.ip);
+    result.sin_port = htons(address.port);
+    return result;
+}
+
+}
+
+bool NetAddress::resolve(const std::string& host, uint16_t portNumber) {
+    if (!startNetworking()) return false;
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &addresses) != 0 || !addresses) return false;
+    ip = ntohl(reinterpret_cast<const sockaddr_in*>(addresses->ai_addr)->sin_addr.s_addr);
+    port = portNumber;
+    freeaddrinfo(addresses);
+    return true;
+}
+
+std::string NetAddress::toString() const {
+    return std::to_string(ip >> 24) + "." + std::to_string((ip >> 16) & 0xff) + "." + std::to_string((ip >> 8) & 0xff) +
+           "." + std::to_string(ip & 0xff) + ":" + std::to_string(port);
+}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+bool UdpSocket::open(uint16_t portNumber) {
+    close();
+    if (!startNetworking()) return false;
+    Socket s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == NO_SOCKET) {
+        std::cerr << "Error creating UDP socket" << std::endl;
+        return false;
+    }
+    sockaddr_in address = toSockaddr({INADDR_ANY, portNumber});
+    socklen_t length = sizeof(address);
+    if (!setNonBlocking(s) || bind(s, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::cerr << "Error binding UDP port " << portNumber << std::endl;
+        closeSocket(s);
+        return false;
+    }
+    handle = static_cast<intptr_t>(s);
+    port = ntohs(address.sin_port);
+    return true;
+}
+
+void UdpSocket::close() {
+    if (!isOpen()) return;
+    closeSocket(static_cast<Socket>(handle));
+    handle = -1;
+    delayed.clear();
+}
+
+bool UdpSocket::isOpen() const {
+    return handle != -1;
+}
+
+void UdpSocket::setConditions(const LinkConditions& value, uint64_t seed) {
+    conditions = value;
+    rng.reseed(seed);
+}
+
+bool UdpSocket::send(const NetAddress& to, const void* data, size_t size) {
+    if (!isOpen()) return false;
+    flushDelayed();
+    counters.packetsSent++;
+    counters.bytesSent += size;
+    if (!conditions.active()) return sendNow(to, data, size);
+
+    if (rng.nextInt(0, 99) < conditions.lossPercent) {
+        counters.packetsLost++;
+        return true;
+    }
+    int delay = conditions.delayMs + rng.nextInt(-conditions.jitterMs, conditions.jitterMs);
+    if (delay <= 0) return sendNow(to, data, size);
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    delayed.push_back({Clock::now() + std::chrono::milliseconds(delay), to, std::vector<uint8_t>(bytes, bytes + size)});
+    return true;
+}
+
+bool UdpSocket::sendNow(const NetAddress& to, const void* data, size_t size) {
+    sockaddr_in address = toSockaddr(to);
+    auto sent = sendto(static_cast<Socket>(handle), static_cast<const char*>(data), static_cast<int>(size), 0,
+                       reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    // A full send buffer loses the packet like the network would
+    return sent == static_cast<decltype(sent)>(size) || (sent < 0 && wouldBlock());
+}
+
+void UdpSocket::flushDelayed() {
+    if (delayed.empty()) return;
+    auto now = Clock::now();
+    // Jitter lets later packets overtake earlier ones, as on a real network
+    auto due = std::stable_partition(delayed.begin(), delayed.end(), [now](const Delayed& d) { return d.due <= now; });
+    for (auto it = delayed.begin(); it != due; ++it) {
+        sendNow(it->to, it->data.data(), it->data.size());
+    }
+    delayed.erase(delayed.begin(), due);
+}
+
+int UdpSocket::receive(NetAddress& from, void* buffer, size_t capacity) {
+    if (!isOpen()) return -1;
+    flushDelayed();
+    sockaddr_in address = {};
+    socklen_t length = sizeof(address);
+    auto received = recvfrom(static_cast<Socket>(handle), static_cast<char*>(buffer), static_cast<int>(capacity), 0,
+                             reinterpret_cast<sockaddr*>(&address), &length);
+    if (received < 0) return -1;
+    from.ip = ntohl(address.sin_addr.s_addr);
+    from.port = ntohs(address.sin_port);
+    counters.packetsReceived++;
+    counters.bytesReceived += received;
+    return static_cast<int>(received);
+}
+
+void UdpSocket::wait(int timeoutMs) {
+    if (!isOpen()) return;
+    if (!delayed.empty()) {
+        auto next = std::min_element(delayed.begin(), delayed.end(),
+                                     [](const Delayed& a, const Delayed& b) { return a.due < b.due; })->due;
+        auto untilDue = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now()).count();
+        timeoutMs = static_cast<int>(std::clamp<long long>(untilDue, 0, timeoutMs));
+    }
+    pollfd entry = {};
+    entry.fd = static_cast<Socket>(handle);
+    entry.events = POLLIN;
+    pollSockets(&entry, 1, timeoutMs);
+    flushDelayed();
+}
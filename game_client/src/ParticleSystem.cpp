@@ -0,0 +1,68 @@
+#include "../include/ParticleSystem.h"
+#include "../include/Profiler.h"
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+ParticleSystem::ParticleSystem(size_t capacity)
+    : maxParticles(capacity), count(0),
+      xs(capacity), ys(capacity), vxs(capacity), vys(capacity), lives(capacity), colors(capacity) {}
+
+bool ParticleSystem::emit(float x, float y, float vx, float vy, uint32_t color, int life) {
+    if (count == maxParticles) return false;
+
+    xs[count] = x;
+    ys[count] = y;
+    vxs[count] = vx;
+    vys[count] = vy;
+    lives[count] = life;
+    colors[count] = color;
+    count++;
+    return true;
+}
+
+void ParticleSystem::update() {
+    PROFILE_ZONE("updateParticles");
+    integrate(0, count);
+    removeExpired();
+}
+
+void ParticleSystem::integrate(size_t begin, size_t end) {
+    float *x = xs.data();
+    float *y = ys.data();
+    const float *vx = vxs.data();
+    const float *vy = vys.data();
+    int32_t *life = lives.data();
+    size_t i = begin;
+
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128i one = _mm_set1_epi32(1);
+    for (; i + 4 <= end; i += 4) {
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(vx + i)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(vy + i)));
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(life + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(life + i), _mm_sub_epi32(l, one));
+    }
+#endif
+
+    for (; i < end; i++) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+        life[i]--;
+    }
+}
+
+void ParticleSystem::removeExpired() {
+    // Walking backwards means whatever gets swapped in has already been checked
+    for (size_t i = count; i-- > 0;) {
+        if (lives[i] > 0) continue;
+
+        size_t last = --count;
+        xs[i] = xs[last];
+        ys[i] = ys[last];
+        vxs[i] = vxs[last];
+        vys[i] = vys[last];
+        lives[i] = lives[last];
+        colors[i] = colors[last];
+    }
+}
@@ -1,4 +1,4 @@
 #include "../include/Player.h"
-Player::Player(int x, int y) : x(x), y(y) {}
+Player::Player(int x, int y) : x(x), y(y), prevX(x), prevY(y) {}
 void Player::moveLeft() {if (x > 0) { x--; }}
 void Player::moveRight(int maxWidth) {if (x < maxWidth - 1) x++;}
\ No newline at end of file
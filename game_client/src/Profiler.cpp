@@ -0,0 +1,189 @@
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace profiler {
+
+std::atomic<bool> enabledFlag{false};
+
+namespace {
+
+const uint64_t RING_CAPACITY = 4096; // Power of two
+const size_t FRAME_HISTORY = 600;
+
+// Single producer, single consumer: only the owning thread writes events and
+// only endFrame() on the main thread reads them
+struct ThreadRing {
+    ZoneEvent events[RING_CAPACITY];
+    std::atomic<uint64_t> head{0};
+    uint64_t tail = 0;
+    uint32_t threadId = 0;
+};
+
+struct TraceEvent {
+    ZoneEvent zone;
+    uint32_t threadId;
+};
+
+const auto epoch = std::chrono::steady_clock::now();
+
+// Rings are never freed, so events from threads that have exited still drain
+std::mutex ringsMutex;
+std::vector<std::unique_ptr<ThreadRing>> rings;
+thread_local ThreadRing* localRing = nullptr;
+
+// Main-thread state
+std::array<double, FRAME_HISTORY> frameTimes;
+size_t frameCount = 0;
+uint64_t lastFrameEnd = 0;
+uint64_t dropped = 0;
+std::vector<ZoneTotal> zoneTotals;
+std::vector<ZoneTotal> pendingTotals;
+
+bool tracing = false;
+std::string tracePath;
+std::vector<TraceEvent> traceEvents;
+
+ThreadRing* registerThread() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(std::make_unique<ThreadRing>());
+    rings.back()->threadId = static_cast<uint32_t>(rings.size());
+    return rings.back().get();
+}
+
+void addTotal(const ZoneEvent& event) {
+    double milliseconds = (event.end - event.start) / 1e6;
+    for (auto& total : pendingTotals) {
+        if (total.name == event.name) {
+            total.milliseconds += milliseconds;
+            total.calls++;
+            return;
+        }
+    }
+    pendingTotals.push_back({event.name, milliseconds, 1});
+}
+
+void drain(ThreadRing& ring) {
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    if (head - ring.tail > RING_CAPACITY) {
+        dropped += head - ring.tail - RING_CAPACITY;
+        ring.tail = head - RING_CAPACITY;
+    }
+    for (; ring.tail < head; ring.tail++) {
+        ZoneEvent event = ring.events[ring.tail & (RING_CAPACITY - 1)];
+        // The writer may have lapped the reader mid-copy; such events are discarded
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring.head.load(std::memory_order_relaxed) - ring.tail >= RING_CAPACITY) {
+            dropped++;
+            continue;
+        }
+        addTotal(event);
+        if (tracing) traceEvents.push_back({event, ring.threadId});
+    }
+}
+
+void drainAll() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (auto& ring : rings) {
+        drain(*ring);
+    }
+}
+
+}
+
+void setEnabled(bool enabled) {
+    if (!enabled) lastFrameEnd = 0;
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void record(const char* name, uint64_t start, uint64_t end) {
+    if (!localRing) localRing = registerThread();
+    uint64_t head = localRing->head.load(std::memory_order_relaxed);
+    localRing->events[head & (RING_CAPACITY - 1)] = {name, start, end};
+    localRing->head.store(head + 1, std::memory_order_release);
+}
+
+void endFrame() {
+    if (!isEnabled()) return;
+    uint64_t frameEnd = now();
+    if (lastFrameEnd) {
+        record("frame", lastFrameEnd, frameEnd);
+        frameTimes[frameCount % FRAME_HISTORY] = (frameEnd - lastFrameEnd) / 1e6;
+        frameCount++;
+    }
+    lastFrameEnd = frameEnd;
+
+    pendingTotals.clear();
+    drainAll();
+    zoneTotals.swap(pendingTotals);
+}
+
+FrameSummary frameSummary() {
+    size_t count = std::min(frameCount, FRAME_HISTORY);
+    if (count == 0) return {0, 0, 0, 0, 0};
+    std::vector<double> sorted(frameTimes.begin(), frameTimes.begin() + count);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) { return sorted[static_cast<size_t>((count - 1) * p)]; };
+    return {percentile(0.50), percentile(0.95), percentile(0.99), sorted.back(), count};
+}
+
+const std::vector<ZoneTotal>& lastFrameZones() {
+    return zoneTotals;
+}
+
+uint64_t droppedEvents() {
+    return dropped;
+}
+
+void startTrace(const std::string& path) {
+    tracing = true;
+    tracePath = path;
+    traceEvents.clear();
+    setEnabled(true);
+}
+
+bool isTracing() {
+    return tracing;
+}
+
+bool writeTrace() {
+    if (!tracing) return false;
+    drainAll();
+    tracing = false;
+
+    std::ofstream out(tracePath, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error writing trace " << tracePath << std::endl;
+        return false;
+    }
+
+    // Chrome trace event format: complete ("X") events, timestamps in microseconds.
+    // Zone names are string literals, so they need no escaping.
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < traceEvents.size(); i++) {
+        const TraceEvent& event = traceEvents[i];
+        out << "{\"name\":\"" << event.zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+            << ",\"ts\":" << event.zone.start / 1e3 << ",\"dur\":" << (event.zone.end - event.zone.start) / 1e3 << "}"
+            << (i + 1 < traceEvents.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+
+    std::cout << "Wrote " << traceEvents.size() << " trace events to " << tracePath;
+    if (dropped) std::cout << " (" << dropped << " dropped)";
+    std::cout << std::endl;
+    traceEvents.clear();
+    return static_cast<bool>(out);
+}
+
+}
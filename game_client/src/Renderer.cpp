@@ -1,4 +1,6 @@
 #include "../include/Renderer.h"
+#include "../include/Profiler.h"
+#include <algorithm>
 #include <iostream>
 
 Renderer::Renderer(SDL_Window* window, int width, int height) 
@@ -11,6 +13,12 @@ Renderer::Renderer(SDL_Window* window, int width, int height)
         return;
     }
     
+    // Present at the display refresh rate; without vsync the frame loop runs uncapped.
+    // SDL_HINT_RENDER_VSYNC=0 opts out, e.g. for benchmarks.
+    if (SDL_GetHintBoolean(SDL_HINT_RENDER_VSYNC, true) && !SDL_SetRenderVSync(renderer, 1)) {
+        std::cerr << "VSync unavailable, rendering uncapped: " << SDL_GetError() << std::endl;
+    }
+    
     // Initialize TTF
     if (!TTF_Init()) {
         std::cerr << "Error initializing TTF: " << SDL_GetError() << std::endl;
@@ -28,13 +36,29 @@ Renderer::~Renderer() {
 }
 
 void Renderer::cleanup() {
-    // Destroy all textures
-    for (auto& pair : textures) {
-        if (pair.second) {
-            SDL_DestroyTexture(pair.second);
+    // Destroy all textures, including glyph atlases
+    spriteBatch.clear();
+    for (auto& entry : textureTable) {
+        if (entry.owned && entry.texture) {
+            SDL_DestroyTexture(entry.texture);
         }
     }
-    textures.clear();
+    textureTable.clear();
+    textureNames.clear();
+    
+    // Destroy cached layers
+    for (Layer& layer : layers) {
+        if (layer.texture) SDL_DestroyTexture(layer.texture);
+    }
+    layers.clear();
+    
+    // Destroy text caches
+    glyphAtlases.clear();
+    for (auto& cached : textCache) {
+        SDL_DestroyTexture(cached.texture);
+    }
+    textCache.clear();
+    textCacheIndex.clear();
     
     // Destroy all fonts
     for (auto& pair : fonts) {
@@ -55,11 +79,17 @@ void Renderer::cleanup() {
 }
 
 void Renderer::clear() {
+    spriteBatch.clear();
     SDL_RenderClear(renderer);
 }
 
 void Renderer::present() {
+    PROFILE_ZONE("present");
+    flushSprites();
     SDL_RenderPresent(renderer);
+    lastFrameStats = frameStats;
+    frameStats = FrameStats();
+    frameArena.reset();
 }
 
 void Renderer::setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
@@ -67,13 +97,51 @@ void Renderer::setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
 }
 
 void Renderer::drawRect(float x, float y, float width, float height) {
+    flushSprites();
     SDL_FRect rect = {x, y, width, height};
     SDL_RenderRect(renderer, &rect);
+    frameStats.drawCalls++;
 }
 
 void Renderer::drawFillRect(float x, float y, float width, float height) {
+    flushSprites();
     SDL_FRect rect = {x, y, width, height};
     SDL_RenderFillRect(renderer, &rect);
+    frameStats.drawCalls++;
+}
+
+void Renderer::drawParticles(const float* x, const float* y, const float* vx, const float* vy,
+                             const uint32_t* colors, size_t count, float size, float offset) {
+    if (count == 0) return;
+    flushSprites();
+    
+    ensureQuadIndices(count);
+    geometryVertices.resize(count * 4);
+    SDL_Vertex* v = geometryVertices.data();
+    float half = size / 2;
+    for (size_t i = 0; i < count; i++, v += 4) {
+        float cx = x[i] + vx[i] * offset;
+        float cy = y[i] + vy[i] * offset;
+        uint32_t c = colors[i];
+        SDL_FColor color = {(c & 0xFF) / 255.0f, ((c >> 8) & 0xFF) / 255.0f,
+                            ((c >> 16) & 0xFF) / 255.0f, (c >> 24) / 255.0f};
+        v[0] = {{cx - half, cy - half}, color, {0, 0}};
+        v[1] = {{cx + half, cy - half}, color, {0, 0}};
+        v[2] = {{cx + half, cy + half}, color, {0, 0}};
+        v[3] = {{cx - half, cy + half}, color, {0, 0}};
+    }
+    
+    SDL_RenderGeometry(renderer, nullptr, geometryVertices.data(), static_cast<int>(count * 4),
+                       geometryIndices.data(), static_cast<int>(count * 6));
+    frameStats.drawCalls++;
+}
+
+void Renderer::ensureQuadIndices(size_t quads) {
+    // Quads share one index pattern, so the index buffer only grows
+    for (size_t quad = geometryIndices.size() / 6; quad < quads; quad++) {
+        int base = static_cast<int>(quad * 4);
+        geometryIndices.insert(geometryIndices.end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+    }
 }
 
 SDL_Texture* Renderer::loadTexture(const std::string& path) {
@@ -96,51 +164,143 @@ SDL_Texture* Renderer::loadTexture(const std::string& path) {
     return texture;
 }
 
-bool Renderer::loadTextureFromFile(const std::string& name, const std::string& path) {
+Renderer::TextureHandle Renderer::registerTexture(const std::string& name, SDL_Texture* texture, bool owned) {
+    float width, height;
+    SDL_GetTextureSize(texture, &width, &height);
+    
+    TextureHandle handle = static_cast<TextureHandle>(textureTable.size());
+    textureTable.push_back({texture, handle, {0, 0, width, height}, width, height, owned});
+    textureNames[name] = handle;
+    return handle;
+}
+
+Renderer::TextureHandle Renderer::loadTextureFromFile(const std::string& name, const std::string& path) {
     SDL_Texture* texture = loadTexture(path);
     if (texture) {
-        textures[name] = texture;
+        frameStats.textureUploads++;
         std::cout << "Loaded texture: " << name << " from " << path << std::endl;
-        return true;
+        return registerTexture(name, texture, true);
     }
-    return false;
+    return INVALID_TEXTURE;
 }
 
-void Renderer::drawTexture(const std::string& textureName, float x, float y, float width, float height) {
-    auto it = textures.find(textureName);
-    if (it == textures.end()) {
-        std::cerr << "Texture not found: " << textureName << std::endl;
-        return;
+Renderer::TextureHandle Renderer::loadTextureFromSurface(const std::string& name, SDL_Surface* surface) {
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_DestroySurface(surface);
+    if (!texture) {
+        std::cerr << "Error creating texture " << name << ": " << SDL_GetError() << std::endl;
+        return INVALID_TEXTURE;
     }
+    frameStats.textureUploads++;
+    return registerTexture(name, texture, true);
+}
+
+Renderer::TextureHandle Renderer::loadTextureFromPixels(const std::string& name, const void* pixels, int width, int height) {
+    // Pixels are RGBA32 and ready to upload as they are
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (!texture || !SDL_UpdateTexture(texture, nullptr, pixels, width * 4)) {
+        std::cerr << "Error creating texture " << name << ": " << SDL_GetError() << std::endl;
+        if (texture) SDL_DestroyTexture(texture);
+        return INVALID_TEXTURE;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    frameStats.textureUploads++;
+    return registerTexture(name, texture, true);
+}
+
+Renderer::TextureHandle Renderer::addTextureRegion(const std::string& name, TextureHandle parent,
+                                                   float x, float y, float width, float height) {
+    if (parent < 0 || parent >= static_cast<TextureHandle>(textureTable.size())) return INVALID_TEXTURE;
     
-    SDL_Texture* texture = it->second;
+    TextureEntry entry = textureTable[parent];
+    entry.region = {x, y, width, height};
+    entry.owned = false;
+    TextureHandle handle = static_cast<TextureHandle>(textureTable.size());
+    textureTable.push_back(entry);
+    textureNames[name] = handle;
+    return handle;
+}
+
+Renderer::TextureHandle Renderer::getTexture(const std::string& name) const {
+    auto it = textureNames.find(name);
+    if (it == textureNames.end()) {
+        std::cerr << "Texture not found: " << name << std::endl;
+        return INVALID_TEXTURE;
+    }
+    return it->second;
+}
+
+void Renderer::drawTexture(TextureHandle texture, float x, float y, float width, float height) {
+    if (texture < 0 || texture >= static_cast<TextureHandle>(textureTable.size())) return;
+    const SDL_FRect& region = textureTable[texture].region;
     
     // If width/height not specified, use texture's original size
-    if (width < 0 || height < 0) {
-        float texWidth, texHeight;
-        SDL_GetTextureSize(texture, &texWidth, &texHeight);
-        if (width < 0) width = texWidth;
-        if (height < 0) height = texHeight;
-    }
+    if (width < 0) width = region.w;
+    if (height < 0) height = region.h;
     
-    SDL_FRect dstRect = {x, y, width, height};
-    SDL_RenderTexture(renderer, texture, nullptr, &dstRect);
+    queueSprite(texture, region, {x, y, width, height}, {1, 1, 1, 1});
 }
 
-void Renderer::drawTexture(const std::string& textureName, float x, float y, 
+void Renderer::drawTexture(TextureHandle texture, float x, float y, 
                           float srcX, float srcY, float srcWidth, float srcHeight, 
                           float dstWidth, float dstHeight) {
-    auto it = textures.find(textureName);
-    if (it == textures.end()) {
-        std::cerr << "Texture not found: " << textureName << std::endl;
-        return;
+    if (texture < 0 || texture >= static_cast<TextureHandle>(textureTable.size())) return;
+    const SDL_FRect& region = textureTable[texture].region;
+    
+    // Source coordinates are relative to the handle's region
+    SDL_FRect srcRect = {region.x + srcX, region.y + srcY, srcWidth, srcHeight};
+    queueSprite(texture, srcRect, {x, y, dstWidth, dstHeight}, {1, 1, 1, 1});
+}
+
+void Renderer::queueSprite(TextureHandle texture, const SDL_FRect& src, const SDL_FRect& dst, const SDL_FColor& color) {
+    spriteBatch.push_back({texture, src, dst, color});
+}
+
+void Renderer::flushSprites() {
+    if (spriteBatch.empty()) return;
+    PROFILE_ZONE("flushSprites");
+    
+    // Sort by underlying texture so atlas regions land in one run,
+    // keeping submission order within a texture
+    spriteOrder.resize(spriteBatch.size());
+    for (size_t i = 0; i < spriteBatch.size(); i++) {
+        int textureId = textureTable[spriteBatch[i].texture].textureId;
+        spriteOrder[i] = (static_cast<uint64_t>(textureId) << 32) | i;
     }
+    std::sort(spriteOrder.begin(), spriteOrder.end());
+    ensureQuadIndices(spriteBatch.size());
     
-    SDL_Texture* texture = it->second;
+    // One geometry call per run of sprites sharing a texture
+    size_t run = 0;
+    while (run < spriteOrder.size()) {
+        const TextureEntry& entry = textureTable[spriteBatch[spriteOrder[run] & 0xFFFFFFFF].texture];
+        float invWidth = 1.0f / entry.textureWidth;
+        float invHeight = 1.0f / entry.textureHeight;
+        
+        geometryVertices.clear();
+        size_t end = run;
+        for (; end < spriteOrder.size(); end++) {
+            const Sprite& sprite = spriteBatch[spriteOrder[end] & 0xFFFFFFFF];
+            if (textureTable[sprite.texture].texture != entry.texture) break;
+            float u0 = sprite.src.x * invWidth, v0 = sprite.src.y * invHeight;
+            float u1 = (sprite.src.x + sprite.src.w) * invWidth, v1 = (sprite.src.y + sprite.src.h) * invHeight;
+            float x0 = sprite.dst.x, y0 = sprite.dst.y;
+            float x1 = x0 + sprite.dst.w, y1 = y0 + sprite.dst.h;
+            geometryVertices.push_back({{x0, y0}, sprite.color, {u0, v0}});
+            geometryVertices.push_back({{x1, y0}, sprite.color, {u1, v0}});
+            geometryVertices.push_back({{x1, y1}, sprite.color, {u1, v1}});
+            geometryVertices.push_back({{x0, y1}, sprite.color, {u0, v1}});
+        }
+        
+        size_t quads = end - run;
+        SDL_RenderGeometry(renderer, entry.texture, geometryVertices.data(), static_cast<int>(quads * 4),
+                           geometryIndices.data(), static_cast<int>(quads * 6));
+        frameStats.drawCalls++;
+        run = end;
+    }
     
-    SDL_FRect srcRect = {srcX, srcY, srcWidth, srcHeight};
-    SDL_FRect dstRect = {x, y, dstWidth, dstHeight};
-    SDL_RenderTexture(renderer, texture, &srcRect, &dstRect);
+    frameStats.sprites += static_cast<int>(spriteBatch.size());
+    spriteBatch.clear();
 }
 
 bool Renderer::loadFont(const std::string& name, const std::string& path, int size) {
@@ -150,65 +310,266 @@ bool Renderer::loadFont(const std::string& name, const std::string& path, int si
         return false;
     }
     
-    fonts[name] = font;
+    addFont(name, font, rasterizeGlyphs(font));
     std::cout << "Loaded font: " << name << " from " << path << " (size " << size << ")" << std::endl;
     return true;
 }
 
-void Renderer::drawText(const std::string& fontName, const std::string& text, float x, float y, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
-    auto it = fonts.find(fontName);
-    if (it == fonts.end()) {
+bool Renderer::loadFontFromMemory(const std::string& name, const void* data, size_t length, int size) {
+    // The memory must stay valid for as long as the font is open
+    TTF_Font* font = TTF_OpenFontIO(SDL_IOFromConstMem(data, length), true, size);
+    if (!font) {
+        std::cerr << "Error loading font " << name << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+    
+    return addFont(name, font, rasterizeGlyphs(font));
+}
+
+Renderer::GlyphSheet Renderer::rasterizeGlyphs(TTF_Font* font) {
+    const int atlasWidth = 512;
+    const int padding = 1;
+    const SDL_Color white = {255, 255, 255, 255};
+    
+    GlyphSheet sheet;
+    
+    // Rasterize every glyph and lay them out in rows
+    SDL_Surface* surfaces[GLYPH_COUNT] = {};
+    int penX = 0, penY = 0, rowHeight = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        Uint32 ch = FIRST_GLYPH + i;
+        int minx, maxx, miny, maxy, advance;
+        if (!TTF_GetGlyphMetrics(font, ch, &minx, &maxx, &miny, &maxy, &advance)) continue;
+        sheet.glyphs[i].advance = advance;
+        
+        surfaces[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (!surfaces[i]) continue;
+        
+        if (penX + surfaces[i]->w > atlasWidth) {
+            penX = 0;
+            penY += rowHeight + padding;
+            rowHeight = 0;
+        }
+        sheet.glyphs[i].src = {static_cast<float>(penX), static_cast<float>(penY),
+                               static_cast<float>(surfaces[i]->w), static_cast<float>(surfaces[i]->h)};
+        penX += surfaces[i]->w + padding;
+        rowHeight = std::max(rowHeight, surfaces[i]->h);
+    }
+    
+    sheet.surface = SDL_CreateSurface(atlasWidth, std::max(1, penY + rowHeight), SDL_PIXELFORMAT_RGBA32);
+    if (sheet.surface) {
+        SDL_FillSurfaceRect(sheet.surface, nullptr, 0);
+        for (int i = 0; i < GLYPH_COUNT; i++) {
+            if (!surfaces[i]) continue;
+            const SDL_FRect& src = sheet.glyphs[i].src;
+            SDL_Rect dst = {static_cast<int>(src.x), static_cast<int>(src.y), surfaces[i]->w, surfaces[i]->h};
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[i], nullptr, sheet.surface, &dst);
+        }
+    }
+    for (SDL_Surface* surface : surfaces) {
+        if (surface) SDL_DestroySurface(surface);
+    }
+    return sheet;
+}
+
+bool Renderer::addFont(const std::string& name, TTF_Font* font, GlyphSheet sheet) {
+    fonts[name] = font;
+    
+    SDL_Texture* texture = sheet.surface ? SDL_CreateTextureFromSurface(renderer, sheet.surface) : nullptr;
+    if (sheet.surface) SDL_DestroySurface(sheet.surface);
+    if (!texture) {
+        std::cerr << "Error creating glyph atlas for " << name << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    frameStats.textureUploads++;
+    
+    GlyphAtlas atlas;
+    atlas.font = font;
+    atlas.texture = registerTexture("font:" + name, texture, true);
+    std::copy(std::begin(sheet.glyphs), std::end(sheet.glyphs), atlas.glyphs);
+    glyphAtlases[name] = atlas;
+    return true;
+}
+
+void Renderer::drawText(const std::string& fontName, std::string_view text, float x, float y, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    PROFILE_ZONE("drawText");
+    auto it = glyphAtlases.find(fontName);
+    if (it == glyphAtlases.end()) {
         std::cerr << "Font not found: " << fontName << std::endl;
         return;
     }
+    const GlyphAtlas& atlas = it->second;
+    SDL_FColor color = {r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f};
     
-    TTF_Font* font = it->second;
+    // One batched quad per glyph
+    float penX = x;
+    Uint32 previous = 0;
+    for (unsigned char ch : text) {
+        if (ch < FIRST_GLYPH || ch >= FIRST_GLYPH + GLYPH_COUNT) continue;
+        const Glyph& glyph = atlas.glyphs[ch - FIRST_GLYPH];
+        
+        int kerning = 0;
+        if (previous && TTF_GetGlyphKerning(atlas.font, previous, ch, &kerning)) penX += kerning;
+        previous = ch;
+        
+        if (glyph.src.w > 0) {
+            queueSprite(atlas.texture, glyph.src, {penX, y, glyph.src.w, glyph.src.h}, color);
+        }
+        penX += glyph.advance;
+    }
+}
+
+const Renderer::CachedText* Renderer::getCachedText(const std::string& fontName, std::string_view text) {
+    textCacheKey.assign(fontName);
+    textCacheKey += '\n';
+    textCacheKey.append(text);
+    auto cached = textCacheIndex.find(textCacheKey);
+    if (cached != textCacheIndex.end()) {
+        // Move to the front as most recently used
+        textCache.splice(textCache.begin(), textCache, cached->second);
+        return &*cached->second;
+    }
+    
+    auto it = fonts.find(fontName);
+    if (it == fonts.end()) {
+        std::cerr << "Font not found: " << fontName << std::endl;
+        return nullptr;
+    }
     
-    // Create text surface with better rendering
-    SDL_Color color = {r, g, b, a};
-    SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), text.length(), color);
+    // Rasterize in white so any colour can be applied as a tint
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* surface = TTF_RenderText_Blended(it->second, text.data(), text.length(), white);
     if (!surface) {
         std::cerr << "Error rendering text: " << SDL_GetError() << std::endl;
-        return;
+        return nullptr;
     }
-    
-    // Create texture from surface
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    float width = static_cast<float>(surface->w);
+    float height = static_cast<float>(surface->h);
+    SDL_DestroySurface(surface);
     if (!texture) {
         std::cerr << "Error creating texture from text: " << SDL_GetError() << std::endl;
-        SDL_DestroySurface(surface);
-        return;
+        return nullptr;
     }
+    frameStats.textureUploads++;
     
-    // Render the texture
-    SDL_FRect dstRect = {x, y, static_cast<float>(surface->w), static_cast<float>(surface->h)};
-    SDL_RenderTexture(renderer, texture, nullptr, &dstRect);
+    // Evict the least recently used string
+    if (textCache.size() >= TEXT_CACHE_CAPACITY) {
+        SDL_DestroyTexture(textCache.back().texture);
+        textCacheIndex.erase(textCache.back().key);
+        textCache.pop_back();
+    }
+    textCache.push_front({textCacheKey, texture, width, height});
+    textCacheIndex[textCacheKey] = textCache.begin();
+    return &textCache.front();
+}
+
+void Renderer::drawTextCentered(const std::string& fontName, std::string_view text, float y, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    PROFILE_ZONE("drawTextCentered");
+    const CachedText* cached = getCachedText(fontName, text);
+    if (!cached) return;
+    flushSprites();
     
-    // Clean up
-    SDL_DestroyTexture(texture);
-    SDL_DestroySurface(surface);
+    SDL_SetTextureColorMod(cached->texture, r, g, b);
+    SDL_SetTextureAlphaMod(cached->texture, a);
+    SDL_FRect dstRect = {(screenWidth - cached->width) / 2.0f, y, cached->width, cached->height};
+    SDL_RenderTexture(renderer, cached->texture, nullptr, &dstRect);
+    frameStats.drawCalls++;
 }
 
-void Renderer::drawTextCentered(const std::string& fontName, const std::string& text, float y, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
-    int textWidth = getTextWidth(fontName, text);
-    float x = (screenWidth - textWidth) / 2.0f;
-    drawText(fontName, text, x, y, r, g, b, a);
+Renderer::LayerHandle Renderer::createLayer(const std::string& name, int width, int height) {
+    Layer layer;
+    layer.name = name;
+    layer.width = width;
+    layer.height = height;
+    layers.push_back(layer);
+    return static_cast<LayerHandle>(layers.size() - 1);
 }
 
-int Renderer::getTextWidth(const std::string& fontName, const std::string& text) {
-    auto it = fonts.find(fontName);
-    if (it == fonts.end()) {
+bool Renderer::beginLayer(LayerHandle handle, uint64_t key) {
+    if (handle < 0 || handle >= static_cast<LayerHandle>(layers.size()) || activeLayer >= 0) return false;
+    Layer& layer = layers[handle];
+    if (layer.valid && layer.key == key) return false;
+    
+    if (!layer.texture) {
+        layer.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET,
+                                          layer.width, layer.height);
+        if (!layer.texture) {
+            std::cerr << "Error creating layer " << layer.name << ": " << SDL_GetError() << std::endl;
+            return false;
+        }
+        // Drawing blended into a transparent target leaves premultiplied colour
+        SDL_SetTextureBlendMode(layer.texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+    }
+    
+    PROFILE_ZONE("rebuildLayer");
+    flushSprites();
+    SDL_SetRenderTarget(renderer, layer.texture);
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    
+    layer.key = key;
+    layer.valid = true;
+    layer.rebuilds++;
+    frameStats.layerRebuilds++;
+    activeLayer = handle;
+    return true;
+}
+
+void Renderer::endLayer() {
+    if (activeLayer < 0) return;
+    flushSprites();
+    SDL_SetRenderTarget(renderer, nullptr);
+    activeLayer = -1;
+}
+
+void Renderer::compositeLayer(LayerHandle handle, float x, float y, const SDL_FRect* src) {
+    if (handle < 0 || handle >= static_cast<LayerHandle>(layers.size())) return;
+    Layer& layer = layers[handle];
+    if (!layer.texture || !layer.valid) return;
+    flushSprites();
+    SDL_FRect dst = {x, y, src ? src->w : static_cast<float>(layer.width), src ? src->h : static_cast<float>(layer.height)};
+    SDL_RenderTexture(renderer, layer.texture, src, &dst);
+    layer.composites++;
+    frameStats.drawCalls++;
+}
+
+void Renderer::invalidateLayers() {
+    for (Layer& layer : layers) {
+        layer.valid = false;
+    }
+}
+
+std::vector<Renderer::LayerStats> Renderer::getLayerStats() const {
+    std::vector<LayerStats> stats;
+    for (const Layer& layer : layers) {
+        stats.push_back({layer.name, layer.rebuilds, layer.composites});
+    }
+    return stats;
+}
+
+int Renderer::getTextWidth(const std::string& fontName, std::string_view text) {
+    auto it = glyphAtlases.find(fontName);
+    if (it == glyphAtlases.end()) {
         std::cerr << "Font not found: " << fontName << std::endl;
         return 0;
     }
+    const GlyphAtlas& atlas = it->second;
     
-    // Estimate width based on font size and character count
-    int fontSize = 16; // Default
-    if (fontName == "pixel_large") fontSize = 48;
-    else if (fontName == "pixel_medium") fontSize = 24;
-    else if (fontName == "pixel_small") fontSize = 16;
-    
-    // Rough estimation: average character width is about 40% of font size
-    int estimatedWidth = static_cast<int>(text.length() * fontSize * 0.4);
-    return estimatedWidth;
+    // Sum of measured advances, matching the layout in drawText
+    int width = 0;
+    Uint32 previous = 0;
+    for (unsigned char ch : text) {
+        if (ch < FIRST_GLYPH || ch >= FIRST_GLYPH + GLYPH_COUNT) continue;
+        int kerning = 0;
+        if (previous && TTF_GetGlyphKerning(atlas.font, previous, ch, &kerning)) width += kerning;
+        previous = ch;
+        width += atlas.glyphs[ch - FIRST_GLYPH].advance;
+    }
+    return width;
 }
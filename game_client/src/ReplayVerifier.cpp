@@ -0,0 +1,86 @@
+#include "../include/ReplayVerifier.h"
+#include "../include/InputRecording.h"
+#include "../include/Simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+
+ReplayVerifier::ReplayVerifier(const VerifyConfig& config) : config(config) {
+    threadCount = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    if (threadCount > 1) pool = std::make_unique<ThreadPool>(threadCount - 1);
+    // One Simulation per thread, restarted for each claim it replays
+    for (unsigned i = 0; i < threadCount; i++) {
+        sims.push_back(std::make_unique<Simulation>(config.width, config.height, 0));
+    }
+}
+
+ReplayVerifier::~ReplayVerifier() = default;
+
+void ReplayVerifier::verify(const std::vector<VerifyClaim>& claims, std::vector<Result>& results) {
+    results.resize(claims.size());
+    // Claims are taken one at a time, as their lengths vary widely
+    std::atomic<size_t> next{0};
+    auto work = [this, &claims, &results, &next](Simulation& sim) {
+        for (size_t i = next++; i < claims.size(); i = next++) {
+            results[i] = verifyWith(claims[i], sim);
+        }
+    };
+
+    std::vector<std::future<void>> done;
+    if (pool && claims.size() > 1) {
+        for (unsigned t = 1; t < threadCount; t++) {
+            Simulation* sim = sims[t].get();
+            done.push_back(pool->submit([&work, sim] { work(*sim); }));
+        }
+    }
+    work(*sims[0]);
+    for (auto& result : done) result.get();
+}
+
+ReplayVerifier::Result ReplayVerifier::verifyOne(const VerifyClaim& claim) {
+    return verifyWith(claim, *sims[0]);
+}
+
+ReplayVerifier::Result ReplayVerifier::verifyWith(const VerifyClaim& claim, Simulation& sim) const {
+    Result result = {Verdict::MALFORMED, 0, 0};
+    InputReplay replay;
+    if (replay.load(claim.log.data(), claim.log.size())) return result;
+    if (replay.getSeed() != claim.seed) {
+        result.verdict = Verdict::WRONG_SEED;
+        return result;
+    }
+    if (replay.getWidth() != config.width || replay.getHeight() != config.height) {
+        result.verdict = Verdict::WRONG_FIELD;
+        return result;
+    }
+
+    sim.restart(claim.seed);
+    InputReplay::Result replayed = replay.run(sim, config.maxUpdates);
+    result.score = sim.getScore();
+    result.updates = replayed.updates;
+    if (replayed.overLimit) {
+        result.verdict = Verdict::TOO_LONG;
+    } else if (replayed.mismatchAt >= 0) {
+        result.verdict = Verdict::HASH_MISMATCH;
+    } else if (replayed.malformed || !replayed.complete) {
+        result.verdict = Verdict::MALFORMED;
+    } else if (result.score != claim.score) {
+        result.verdict = Verdict::SCORE_MISMATCH;
+    } else {
+        result.verdict = Verdict::ACCEPTED;
+    }
+    return result;
+}
+
+const char* ReplayVerifier::verdictName(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::ACCEPTED: return "accepted";
+        case Verdict::MALFORMED: return "malformed";
+        case Verdict::WRONG_SEED: return "wrong_seed";
+        case Verdict::WRONG_FIELD: return "wrong_field";
+        case Verdict::TOO_LONG: return "too_long";
+        case Verdict::HASH_MISMATCH: return "hash_mismatch";
+        case Verdict::SCORE_MISMATCH: return "score_mismatch";
+    }
+    return "unknown";
+}
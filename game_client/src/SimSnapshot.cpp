@@ -0,0 +1,41 @@
+#include "../include/SimSnapshot.h"
+
+void SimSnapshot::Entities::capture(const EntityStore& store) {
+    size_t count = store.size();
+    x.assign(store.xData(), store.xData() + count);
+    y.assign(store.yData(), store.yData() + count);
+    prevX.assign(store.prevXData(), store.prevXData() + count);
+    prevY.assign(store.prevYData(), store.prevYData() + count);
+}
+
+void SimSnapshot::Particles::capture(const ParticleSystem& particles) {
+    size_t count = particles.size();
+    x.assign(particles.xData(), particles.xData() + count);
+    y.assign(particles.yData(), particles.yData() + count);
+    vx.assign(particles.vxData(), particles.vxData() + count);
+    vy.assign(particles.vyData(), particles.vyData() + count);
+    color.assign(particles.colorData(), particles.colorData() + count);
+}
+
+void SimSnapshot::capture(const Simulation& sim, int localPlayer) {
+    state = sim.getGameState();
+    score = sim.getScore();
+    tick = sim.getTick();
+    playerX = sim.getPlayer(localPlayer).x;
+    playerY = sim.getPlayer(localPlayer).y;
+    others.x.clear();
+    others.y.clear();
+    others.prevX.clear();
+    others.prevY.clear();
+    for (int i = 0; i < sim.getPlayerCount(); i++) {
+        const Player& player = sim.getPlayer(i);
+        if (i == localPlayer || !player.active) continue;
+        others.x.push_back(static_cast<int16_t>(player.x));
+        others.y.push_back(static_cast<int16_t>(player.y));
+        others.prevX.push_back(static_cast<int16_t>(player.prevX));
+        others.prevY.push_back(static_cast<int16_t>(player.prevY));
+    }
+    enemies.capture(sim.getEnemies());
+    bullets.capture(sim.getBullets());
+    particles.capture(sim.getParticles());
+}
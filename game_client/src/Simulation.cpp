@@ -0,0 +1,345 @@
+#include "../include/Simulation.h"
+#include "../include/Profiler.h"
+#include "../include/StateSnapshot.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+Simulation::Simulation(int w, int h, uint64_t seed)
+    : width(w), height(h), tick(0), score(0), difficulty(1.0f), enemiesSpawned(0),
+      currentState(MENU), players(1, Player(w/2/TILE_SIZE, h/TILE_SIZE-1)), seed(seed),
+      spawnRng(seed), effectsRng(seed ^ EFFECTS_STREAM),
+      collisionMode(CollisionMode::BITBOARD), collisionGrid(w/TILE_SIZE, h/TILE_SIZE) {
+    // Entity pools sized for a full grid, up to a cap, so that a normal game
+    // never grows them mid-frame; larger worlds grow past the cap as needed
+    size_t poolCapacity = std::min<size_t>(static_cast<size_t>(getColumns()) * getRows(), ENTITY_POOL_CAPACITY);
+    players.reserve(MAX_PLAYERS);
+    enemies.reserve(poolCapacity);
+    bullets.reserve(poolCapacity);
+    hits.reserve(poolCapacity);
+    tickHits.reserve(poolCapacity);
+}
+
+void Simulation::applyAction(Action action, int index) {
+    if (index < 0 || index >= getPlayerCount() || !players[index].active) return;
+    Player& player = players[index];
+
+    switch (currentState) {
+        case MENU:
+            if (action == Action::FIRE || action == Action::CONFIRM) {
+                setGameState(PLAYING);
+                reset();
+            }
+            break;
+
+        case PLAYING:
+            switch (action) {
+                case Action::PAUSE:
+                    setGameState(PAUSED);
+                    break;
+                case Action::FIRE:
+                    // Shoot bullet
+                    bullets.spawn(player.x, player.y - 1);
+                    break;
+                case Action::MOVE_LEFT:
+                    player.moveLeft();
+                    break;
+                case Action::MOVE_RIGHT:
+                    player.moveRight(getColumns());
+                    break;
+                default:
+                    break;
+            }
+            break;
+
+        case PAUSED:
+            if (action == Action::PAUSE) {
+                setGameState(PLAYING);
+            }
+            break;
+
+        case GAME_OVER:
+            if (action == Action::FIRE || action == Action::CONFIRM) {
+                setGameState(MENU);
+            }
+            break;
+    }
+}
+
+void Simulation::restart(uint64_t newSeed) {
+    seed = newSeed;
+    spawnRng.reseed(seed);
+    effectsRng.reseed(seed ^ EFFECTS_STREAM);
+    players.assign(1, Player(width/2/TILE_SIZE, height/TILE_SIZE-1));
+    currentState = MENU;
+    hits.clear();
+    tickHits.clear();
+    reset();
+}
+
+void Simulation::reset() {
+    // Clear all enemies, bullets, and particles
+    enemies.clear();
+    bullets.clear();
+    particles.clear();
+
+    // Reset players to their initial positions, spread along the bottom row
+    // (a lone player starts at the center)
+    for (int i = 0; i < getPlayerCount(); i++) {
+        Player& player = players[i];
+        player.x = player.prevX = getColumns() * (i + 1) / (getPlayerCount() + 1);
+        player.y = player.prevY = getRows() - 1;
+    }
+
+    // Reset game state
+    tick = 0;
+    score = 0;
+    difficulty = 1.0;
+    enemiesSpawned = 0;
+}
+
+int Simulation::addPlayer() {
+    for (int i = 1; i < getPlayerCount(); i++) {
+        if (!players[i].active) {
+            players[i] = Player(getColumns() * (i + 1) / (getPlayerCount() + 1), getRows() - 1);
+            return i;
+        }
+    }
+    if (getPlayerCount() == MAX_PLAYERS) return -1;
+    int index = getPlayerCount();
+    players.emplace_back(getColumns() * (index + 1) / (index + 2), getRows() - 1);
+    return index;
+}
+
+void Simulation::removePlayer(int index) {
+    // Player 0 is always present
+    if (index > 0 && index < getPlayerCount()) players[index].active = false;
+}
+
+void Simulation::update() {
+    // Done even when not playing so that a paused world renders without motion
+    savePreviousPositions();
+    tickHits.clear();
+
+    if (currentState != PLAYING) return;
+
+    tick++;
+    spawnEnemies();
+
+    // Move bullets upward
+    forEachRange(bullets.size(), [this](size_t begin, size_t end) { bullets.moveY(-1, begin, end); });
+
+    // Move enemies downward (slower - every 2 ticks instead of every tick)
+    if (tick % 2 == 0) {
+        forEachRange(enemies.size(), [this](size_t begin, size_t end) { enemies.moveY(1, begin, end); });
+    }
+
+    // Enhanced collision detection
+    resolveCollisions();
+
+    // Remove bullets that are off-screen and enemies that reached the player's row
+    removeOffScreenBullets();
+    removeBreachingEnemies();
+
+    // Remove dead entities
+    enemies.removeDead();
+    bullets.removeDead();
+
+    updateEffects();
+}
+
+void Simulation::updateEffects() {
+    // Removal reorders the pool, so only integration is split
+    PROFILE_ZONE("updateParticles");
+    forEachRange(particles.size(), [this](size_t begin, size_t end) { particles.integrate(begin, end); });
+    particles.removeExpired();
+}
+
+uint64_t Simulation::stateHash() const {
+    // FNV-1a over everything that decides future ticks; particles are
+    // cosmetic, so only their count and generator take part
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+    };
+    auto mixValue = [&mix](auto value) { mix(&value, sizeof(value)); };
+
+    mixValue(static_cast<int32_t>(currentState));
+    mixValue(static_cast<int32_t>(tick));
+    mixValue(static_cast<int32_t>(score));
+    mixValue(static_cast<int32_t>(enemiesSpawned));
+    mixValue(static_cast<int32_t>(players[0].x));
+    mixValue(static_cast<int32_t>(players[0].y));
+    // Single-player hashes stay as they were before co-op, so older
+    // recordings still verify
+    for (int i = 1; i < getPlayerCount(); i++) {
+        mixValue(static_cast<int32_t>(players[i].active));
+        mixValue(static_cast<int32_t>(players[i].x));
+        mixValue(static_cast<int32_t>(players[i].y));
+    }
+    for (const EntityStore* store : {&enemies, &bullets}) {
+        mixValue(static_cast<uint64_t>(store->size()));
+        mix(store->xData(), store->size() * sizeof(int16_t));
+        mix(store->yData(), store->size() * sizeof(int16_t));
+    }
+    mixValue(static_cast<uint64_t>(particles.size()));
+    mix(spawnRng.getState(), 4 * sizeof(uint64_t));
+    mix(effectsRng.getState(), 4 * sizeof(uint64_t));
+    return hash;
+}
+
+bool Simulation::restore(const SnapshotView& snapshot, bool keepParticles) {
+    const snapshot::SnapshotHeader& header = snapshot.header();
+    uint32_t playerCount = snapshot.count(snapshot::PLAYERS);
+    if (header.width != width || header.height != height || playerCount == 0 || playerCount > MAX_PLAYERS) {
+        return false;
+    }
+
+    currentState = static_cast<GameState>(header.state);
+    tick = header.tick;
+    score = header.score;
+    enemiesSpawned = header.enemiesSpawned;
+    difficulty = header.difficulty;
+    seed = header.seed;
+    spawnRng.setState(header.spawnRng);
+    effectsRng.setState(header.effectsRng);
+
+    players.resize(playerCount, Player(0, 0));
+    for (uint32_t i = 0; i < playerCount; i++) {
+        Player& player = players[i];
+        int16_t x = snapshot.column(snapshot::PLAYERS, snapshot::X)[i];
+        player.active = x >= 0;
+        player.x = player.active ? x : 0;
+        player.y = snapshot.column(snapshot::PLAYERS, snapshot::Y)[i];
+        player.prevX = snapshot.column(snapshot::PLAYERS, snapshot::PREV_X)[i];
+        player.prevY = snapshot.column(snapshot::PLAYERS, snapshot::PREV_Y)[i];
+    }
+
+    for (auto [store, group] : {std::pair{&enemies, snapshot::ENEMIES}, std::pair{&bullets, snapshot::BULLETS}}) {
+        store->assign(snapshot.column(group, snapshot::X), snapshot.column(group, snapshot::Y),
+                      snapshot.column(group, snapshot::PREV_X), snapshot.column(group, snapshot::PREV_Y),
+                      snapshot.count(group));
+    }
+    if (!keepParticles) particles.clear();
+    return true;
+}
+
+void Simulation::spawnEnemies() {
+    // Increase difficulty every 10 enemies
+    difficulty = 1.0f + (enemiesSpawned / 10) * 0.1f;
+
+    // Fixed schedule; recordings replay against it, so changing it breaks them
+    if (tick % 30 == 0) { // Spawn every 30 ticks (about every 0.5 seconds at 60 FPS)
+        int gameWidth = width / TILE_SIZE;
+        enemies.spawn(spawnRng.nextInt(0, gameWidth - 1), 0);
+        enemiesSpawned++;
+    }
+}
+
+void Simulation::savePreviousPositions() {
+    for (Player& player : players) {
+        player.prevX = player.x;
+        player.prevY = player.y;
+    }
+    forEachRange(bullets.size(), [this](size_t begin, size_t end) { bullets.savePreviousPositions(begin, end); });
+    forEachRange(enemies.size(), [this](size_t begin, size_t end) { enemies.savePreviousPositions(begin, end); });
+}
+
+// Game state management
+void Simulation::setGameState(GameState newState) {
+    currentState = newState;
+}
+
+// Enhanced collision detection
+void Simulation::resolveCollisions() {
+    PROFILE_ZONE("collision");
+    if (collisionMode == CollisionMode::NESTED_LOOP) {
+        findHitsNestedLoop(bullets, enemies, hits);
+    } else if (!jobs || bullets.size() < PARALLEL_THRESHOLD) {
+        collisionGrid.findHits(bullets, enemies, hits);
+    } else {
+        // Each chunk of bullets collects into its own list; concatenating
+        // the lists in chunk order reproduces the serial hit order
+        hits.clear();
+        if (collisionGrid.prepare(bullets, enemies)) {
+            chunkHits.resize((bullets.size() + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN);
+            jobs->parallelFor(bullets.size(), PARALLEL_GRAIN, [this](size_t begin, size_t end) {
+                std::vector<Hit>& chunk = chunkHits[begin / PARALLEL_GRAIN];
+                chunk.clear();
+                collisionGrid.collectHits(bullets, begin, end, chunk);
+            });
+            for (const auto& chunk : chunkHits) {
+                hits.insert(hits.end(), chunk.begin(), chunk.end());
+            }
+        }
+    }
+
+    // Score and effects are applied serially in hit order, so the score and
+    // the effects generator advance exactly as in the serial path
+    for (const auto &hit : hits) {
+        enemies.kill(hit.enemy);
+        bullets.kill(hit.bullet);
+        score += 10;
+        // Create hit effect particles
+        int x = enemies.getX(hit.enemy);
+        int y = enemies.getY(hit.enemy);
+        tickHits.emplace_back(static_cast<int16_t>(x), static_cast<int16_t>(y));
+        createHitEffect(x, y);
+    }
+}
+
+void Simulation::removeOffScreenBullets() {
+    // Remove bullets that have gone off the top
+    forEachRange(bullets.size(), [this](size_t begin, size_t end) {
+        bullets.killIf([](int, int y) { return y < 0; }, begin, end);
+    });
+}
+
+void Simulation::removeBreachingEnemies() {
+    int bottomRow = height / TILE_SIZE - 1;
+    std::atomic<int> breached{0};
+    forEachRange(enemies.size(), [this, bottomRow, &breached](size_t begin, size_t end) {
+        breached += enemies.killIf([bottomRow](int, int y) { return y >= bottomRow; }, begin, end);
+    });
+    if (breached > 0 && !endless) {
+        setGameState(GAME_OVER);
+    }
+}
+
+void Simulation::createHitEffect(int x, int y) {
+    // Velocities for the eight 45-degree explosion directions at each speed
+    static const int DIRECTIONS = 8;
+    static const int SPEEDS = 3;
+    static const auto velocities = [] {
+        std::array<std::array<float, 2>, DIRECTIONS * SPEEDS> table;
+        for (int s = 0; s < SPEEDS; s++) {
+            for (int i = 0; i < DIRECTIONS; i++) {
+                float angle = (i * 45.0f) * 3.14159f / 180.0f;
+                float speed = 2.0f + s;
+                table[s * DIRECTIONS + i] = {std::cos(angle) * speed, std::sin(angle) * speed};
+            }
+        }
+        return table;
+    }();
+
+    float pixelX = gameToPixelX(x) + TILE_SIZE/2;
+    float pixelY = gameToPixelY(y) + TILE_SIZE/2;
+
+    // Create explosion particles
+    for (int i = 0; i < DIRECTIONS * effectScale; i++) {
+        // One random draw per particle supplies speed, colour and lifetime
+        uint32_t bits = static_cast<uint32_t>(effectsRng.next() >> 33);
+        int speed = bits % SPEEDS;
+        bits /= SPEEDS;
+        uint8_t g = 100 + (bits % 155);
+        bits /= 155;
+        int life = 20 + (bits % 20);
+
+        const auto &v = velocities[speed * DIRECTIONS + i % DIRECTIONS];
+        particles.emit(pixelX, pixelY, v[0], v[1], ParticleSystem::packColor(255, g, 0), life);
+    }
+}
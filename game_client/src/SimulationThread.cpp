@@ -0,0 +1,125 @@
+#include "../include/SimulationThread.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <chrono>
+
+SimulationThread::SimulationThread(Simulation& sim, InputRecorder& recorder)
+    : sim(sim), recorder(recorder) {}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread([this] { loop(); });
+}
+
+void SimulationThread::stop() {
+    if (!running.exchange(false)) return;
+    wake.release();
+    thread.join();
+}
+
+bool SimulationThread::pushAction(Simulation::Action action) {
+    if (!actions.push(action)) return false;
+    // Only the first action since the thread last woke needs to signal it
+    if (!wakePending.exchange(true, std::memory_order_acq_rel)) {
+        wake.release();
+    }
+    return true;
+}
+
+const SimSnapshot& SimulationThread::latest(uint32_t actions, std::chrono::microseconds timeout) {
+    // The thread wakes as soon as an action is pushed, so this is normally
+    // a few microseconds; counts are compared modulo 2^32
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    const SimSnapshot* snapshot = &snapshots.read();
+    while (static_cast<int32_t>(snapshot->actionsApplied - actions) < 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+        snapshot = &snapshots.read();
+    }
+    return *snapshot;
+}
+
+bool SimulationThread::applyPendingActions() {
+    bool applied = false;
+    Simulation::Action action;
+    while (actions.pop(action)) {
+        recorder.recordAction(action);
+        sim.applyAction(action);
+        actionsApplied++;
+        applied = true;
+    }
+    return applied;
+}
+
+void SimulationThread::publish(int64_t updateTime, bool settled) {
+    PROFILE_ZONE("publishSnapshot");
+    SimSnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.capture(sim);
+    snapshot.updateTime = updateTime;
+    snapshot.actionsApplied = actionsApplied;
+    snapshot.settled = settled;
+    snapshots.publish();
+}
+
+void SimulationThread::loop() {
+    using Clock = std::chrono::steady_clock;
+    const auto tickTime = std::chrono::nanoseconds(std::chrono::seconds(1)) / Simulation::TICKS_PER_SECOND;
+    const auto maxLag = tickTime * 5; // Avoid a catch-up spiral after a stall
+
+    auto nextUpdate = Clock::now();
+    auto lastUpdate = nextUpdate;
+    bool settled = false;
+    publish(lastUpdate.time_since_epoch().count(), settled);
+
+    while (running.load(std::memory_order_acquire)) {
+        // Sleep until the next tick is due or input arrives, whichever is
+        // first; with a network poll, never longer than its interval. Once
+        // settled, only input wakes the thread.
+        if (settled) {
+            wake.acquire();
+        } else {
+            auto wakeAt = nextUpdate;
+            if (onPoll) wakeAt = std::min(wakeAt, Clock::now() + pollInterval);
+            (void)wake.try_acquire_until(wakeAt);
+        }
+        wakePending.store(false, std::memory_order_release);
+        wakeupCount.fetch_add(1, std::memory_order_relaxed);
+
+        bool changed = applyPendingActions();
+        if (onPoll && onPoll(sim)) changed = true;
+
+        auto now = Clock::now();
+        if (settled) {
+            // Ticks resume a tick after the wakeup rather than catching up
+            // on the time spent asleep
+            nextUpdate = now + tickTime;
+            settled = false;
+            changed = true;
+        }
+        if (now - nextUpdate > maxLag) nextUpdate = now - maxLag;
+        bool staticTick = false;
+        while (nextUpdate <= now) {
+            PROFILE_ZONE("simTick");
+            bool wasOver = sim.getGameState() == Simulation::GAME_OVER;
+            staticTick = sim.getGameState() != Simulation::PLAYING;
+            sim.update();
+            recorder.recordUpdate(sim);
+            if (!wasOver && sim.getGameState() == Simulation::GAME_OVER && onGameOver) onGameOver(sim);
+            if (onUpdate) onUpdate(sim);
+            lastUpdate = nextUpdate;
+            nextUpdate += tickTime;
+            changed = true;
+        }
+
+        // A tick outside play only settles previous positions; after one,
+        // further ticks change nothing until an action arrives, and an action
+        // pushed from here on still releases the semaphore. A network host
+        // keeps ticking for its clients.
+        if (staticTick && !onPoll) settled = true;
+
+        if (changed) publish(lastUpdate.time_since_epoch().count(), settled);
+    }
+}
@@ -0,0 +1,254 @@
+#include "../include/StateSnapshot.h"
+#include "../include/Simulation.h"
+#include <cstring>
+
+namespace {
+
+using snapshot::DeltaHeader;
+using snapshot::SnapshotHeader;
+
+// The header between the version fields and the seed is compared as 32-bit
+// words, and from the seed on as 64-bit words
+const size_t WORDS32_OFFSET = 8;
+const size_t WORDS32 = (offsetof(SnapshotHeader, seed) - WORDS32_OFFSET) / 4;
+const size_t WORDS64_OFFSET = offsetof(SnapshotHeader, seed);
+const size_t WORDS64 = (sizeof(SnapshotHeader) - WORDS64_OFFSET) / 8;
+
+// Far above any entity pool; bounds what a delta can make applyDelta allocate
+const uint32_t MAX_GROUP_COUNT = 1 << 16;
+
+size_t fullSize(const uint32_t counts[snapshot::GROUPS]) {
+    size_t entities = 0;
+    for (int group = 0; group < snapshot::GROUPS; group++) entities += counts[group];
+    return sizeof(SnapshotHeader) + snapshot::FIELDS * entities * sizeof(int16_t);
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Bounds-checked reader over a delta body
+struct Reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos == end) break;
+            uint8_t byte = *pos++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+uint32_t zigzag(int32_t value) { return (uint32_t(value) << 1) ^ uint32_t(value >> 31); }
+int32_t unzigzag(uint32_t value) { return int32_t(value >> 1) ^ -int32_t(value & 1); }
+
+struct Column {
+    const int16_t* data;
+    uint32_t count;
+};
+
+// Count, then runs of equal differences from the base; entities past the end
+// of the base column are differenced against zero
+void encodeColumn(std::vector<uint8_t>& out, Column base, Column target) {
+    putVarint(out, target.count);
+    uint32_t run = 0;
+    uint32_t current = 0;
+    for (uint32_t i = 0; i < target.count; i++) {
+        int16_t from = i < base.count ? base.data[i] : 0;
+        uint32_t diff = zigzag(int16_t(uint16_t(target.data[i] - from)));
+        if (run > 0 && diff != current) {
+            putVarint(out, run);
+            putVarint(out, current);
+            run = 0;
+        }
+        current = diff;
+        run++;
+    }
+    if (run > 0) {
+        putVarint(out, run);
+        putVarint(out, current);
+    }
+}
+
+bool decodeColumn(Reader& in, Column base, int16_t* target, uint32_t count) {
+    if (in.varint() != count || !in.ok) return false;
+    uint32_t i = 0;
+    while (i < count) {
+        uint64_t run = in.varint();
+        int32_t diff = unzigzag(static_cast<uint32_t>(in.varint()));
+        if (!in.ok || run == 0 || run > count - i) return false;
+        for (uint64_t r = 0; r < run; r++, i++) {
+            int16_t from = i < base.count ? base.data[i] : 0;
+            target[i] = int16_t(uint16_t(from + diff));
+        }
+    }
+    return true;
+}
+
+}
+
+bool SnapshotView::open(const uint8_t* data, size_t size) {
+    head = nullptr;
+    if (size < sizeof(SnapshotHeader) || reinterpret_cast<uintptr_t>(data) % alignof(SnapshotHeader) != 0) {
+        return false;
+    }
+    const SnapshotHeader* candidate = reinterpret_cast<const SnapshotHeader*>(data);
+    if (std::memcmp(candidate->magic, snapshot::MAGIC, 4) != 0 || candidate->version != snapshot::VERSION ||
+        candidate->headerSize != sizeof(SnapshotHeader) || size != fullSize(candidate->counts)) {
+        return false;
+    }
+    head = candidate;
+    columns = reinterpret_cast<const int16_t*>(data + sizeof(SnapshotHeader));
+    size_t offset = 0;
+    for (int group = 0; group < snapshot::GROUPS; group++) {
+        groupOffset[group] = offset;
+        offset += snapshot::FIELDS * size_t(head->counts[group]);
+    }
+    bytes = size;
+    return true;
+}
+
+void encodeSnapshot(const Simulation& sim, std::vector<uint8_t>& out) {
+    const EntityStore& enemies = sim.getEnemies();
+    const EntityStore& bullets = sim.getBullets();
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, snapshot::MAGIC, 4);
+    header.version = snapshot::VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.width = sim.getWidth();
+    header.height = sim.getHeight();
+    header.state = sim.getGameState();
+    header.tick = sim.getTick();
+    header.score = sim.getScore();
+    header.enemiesSpawned = sim.getEnemiesSpawned();
+    header.difficulty = sim.getDifficulty();
+    header.counts[snapshot::ENEMIES] = static_cast<uint32_t>(enemies.size());
+    header.counts[snapshot::BULLETS] = static_cast<uint32_t>(bullets.size());
+    header.counts[snapshot::PLAYERS] = static_cast<uint32_t>(sim.getPlayerCount());
+    header.seed = sim.getSeed();
+    std::memcpy(header.spawnRng, sim.getSpawnRng().getState(), sizeof(header.spawnRng));
+    std::memcpy(header.effectsRng, sim.getEffectsRng().getState(), sizeof(header.effectsRng));
+
+    out.resize(fullSize(header.counts));
+    std::memcpy(out.data(), &header, sizeof(header));
+    int16_t* pos = reinterpret_cast<int16_t*>(out.data() + sizeof(header));
+    for (const EntityStore* store : {&enemies, &bullets}) {
+        for (const int16_t* column : {store->xData(), store->yData(), store->prevXData(), store->prevYData()}) {
+            std::copy(column, column + store->size(), pos);
+            pos += store->size();
+        }
+    }
+    int players = sim.getPlayerCount();
+    for (int i = 0; i < players; i++) {
+        const Player& player = sim.getPlayer(i);
+        pos[i] = static_cast<int16_t>(player.active ? player.x : -1);
+        pos[players + i] = static_cast<int16_t>(player.y);
+        pos[2 * players + i] = static_cast<int16_t>(player.prevX);
+        pos[3 * players + i] = static_cast<int16_t>(player.prevY);
+    }
+}
+
+void encodeDelta(const SnapshotView& base, const SnapshotView& target, std::vector<uint8_t>& out) {
+    DeltaHeader header = {};
+    std::memcpy(header.magic, snapshot::DELTA_MAGIC, 4);
+    header.version = snapshot::VERSION;
+    header.baseTick = base.header().tick;
+    header.baseSize = static_cast<uint32_t>(base.size());
+    header.size = static_cast<uint32_t>(target.size());
+
+    out.clear();
+    out.resize(sizeof(header));
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    const uint8_t* fromBytes = base.data();
+    const uint8_t* toBytes = target.data();
+    for (size_t i = 0; i < WORDS32; i++) {
+        uint32_t a, b;
+        std::memcpy(&a, fromBytes + WORDS32_OFFSET + i * 4, 4);
+        std::memcpy(&b, toBytes + WORDS32_OFFSET + i * 4, 4);
+        putVarint(out, zigzag(int32_t(b - a)));
+    }
+    for (size_t i = 0; i < WORDS64; i++) {
+        uint64_t a, b;
+        std::memcpy(&a, fromBytes + WORDS64_OFFSET + i * 8, 8);
+        std::memcpy(&b, toBytes + WORDS64_OFFSET + i * 8, 8);
+        putVarint(out, a ^ b);
+    }
+
+    for (int g = 0; g < snapshot::GROUPS; g++) {
+        auto group = static_cast<snapshot::Group>(g);
+        Column targetX = {target.column(group, snapshot::X), target.count(group)};
+        Column targetY = {target.column(group, snapshot::Y), target.count(group)};
+        encodeColumn(out, {base.column(group, snapshot::X), base.count(group)}, targetX);
+        encodeColumn(out, {base.column(group, snapshot::Y), base.count(group)}, targetY);
+        encodeColumn(out, targetX, {target.column(group, snapshot::PREV_X), target.count(group)});
+        encodeColumn(out, targetY, {target.column(group, snapshot::PREV_Y), target.count(group)});
+    }
+}
+
+bool applyDelta(const SnapshotView& base, const uint8_t* delta, size_t size, std::vector<uint8_t>& out) {
+    DeltaHeader header;
+    if (size < sizeof(header)) return false;
+    std::memcpy(&header, delta, sizeof(header));
+    if (std::memcmp(header.magic, snapshot::DELTA_MAGIC, 4) != 0 || header.version != snapshot::VERSION ||
+        header.baseTick != base.header().tick || header.baseSize != base.size() ||
+        header.size < sizeof(SnapshotHeader)) {
+        return false;
+    }
+
+    // Rebuild the header on the stack and check it before sizing out, so a
+    // corrupt delta can't request an arbitrary allocation
+    Reader in = {delta + sizeof(header), delta + size};
+    SnapshotHeader to;
+    const uint8_t* fromBytes = base.data();
+    uint8_t* headerBytes = reinterpret_cast<uint8_t*>(&to);
+    std::memcpy(headerBytes, fromBytes, WORDS32_OFFSET);
+    for (size_t i = 0; i < WORDS32; i++) {
+        uint32_t word;
+        std::memcpy(&word, fromBytes + WORDS32_OFFSET + i * 4, 4);
+        word += uint32_t(unzigzag(static_cast<uint32_t>(in.varint())));
+        std::memcpy(headerBytes + WORDS32_OFFSET + i * 4, &word, 4);
+    }
+    for (size_t i = 0; i < WORDS64; i++) {
+        uint64_t word;
+        std::memcpy(&word, fromBytes + WORDS64_OFFSET + i * 8, 8);
+        word ^= in.varint();
+        std::memcpy(headerBytes + WORDS64_OFFSET + i * 8, &word, 8);
+    }
+    if (!in.ok || header.size != fullSize(to.counts)) return false;
+    for (int group = 0; group < snapshot::GROUPS; group++) {
+        if (to.counts[group] > MAX_GROUP_COUNT) return false;
+    }
+
+    out.resize(header.size);
+    uint8_t* toBytes = out.data();
+    std::memcpy(toBytes, &to, sizeof(to));
+
+    int16_t* columns = reinterpret_cast<int16_t*>(toBytes + sizeof(SnapshotHeader));
+    for (int g = 0; g < snapshot::GROUPS; g++) {
+        auto group = static_cast<snapshot::Group>(g);
+        uint32_t count = to.counts[group];
+        int16_t* x = columns;
+        int16_t* y = columns + count;
+        columns += snapshot::FIELDS * size_t(count);
+        if (!decodeColumn(in, {base.column(group, snapshot::X), base.count(group)}, x, count) ||
+            !decodeColumn(in, {base.column(group, snapshot::Y), base.count(group)}, y, count) ||
+            !decodeColumn(in, {x, count}, y + count, count) ||
+            !decodeColumn(in, {y, count}, y + 2 * count, count)) {
+            return false;
+        }
+    }
+    return in.pos == in.end;
+}
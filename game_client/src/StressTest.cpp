@@ -0,0 +1,107 @@
+#include "../include/StressTest.h"
+#include <algorithm>
+#include <chrono>
+
+StressTest::StressTest(const StressConfig& config)
+    : config(config), sim(config.columns * Simulation::TILE_SIZE, config.rows * Simulation::TILE_SIZE, config.seed),
+      rng(config.seed), spawnRate(config.spawnRate), fireRate(config.fireRate) {
+    sim.setEndless(true);
+    sim.setEffectScale(config.particleMultiplier);
+    sim.applyAction(Simulation::Action::CONFIRM);
+}
+
+void StressTest::spawnLoad() {
+    // Fractional rates carry over, so 0.5 spawns on every other tick
+    spawnCarry += spawnRate;
+    for (; spawnCarry >= 1.0; spawnCarry -= 1.0) {
+        sim.spawnEnemy(rng.nextInt(0, config.columns - 1), 0);
+    }
+
+    // Bullets fan out from a sweep that moves every tick. Only even columns
+    // are fired on, so enemies in odd columns live to the bottom and both
+    // populations grow with the rates.
+    int lanes = std::max(1, config.columns / 2);
+    fireCarry += fireRate;
+    int shots = static_cast<int>(fireCarry);
+    fireCarry -= shots;
+    for (int i = 0; i < shots; i++) {
+        sim.spawnBullet((sweep + i * lanes / std::max(shots, 1)) % lanes * 2, config.rows - 2);
+    }
+    sweep = (sweep + 1) % lanes;
+}
+
+double StressTest::tick() {
+    spawnLoad();
+    auto start = std::chrono::steady_clock::now();
+    sim.update();
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    simulationWindow.totalMs += milliseconds;
+    simulationWindow.samples++;
+    ticks++;
+
+    if (ticks % config.rampTicks == 0) {
+        closeWindow(simulationWindow, simulationCapacity);
+        if (renderMeasured) closeWindow(renderWindow, renderCapacity);
+        spawnRate *= config.rampFactor;
+        fireRate *= config.rampFactor;
+    }
+    return milliseconds;
+}
+
+void StressTest::render(RenderBackend& backend) {
+    snapshot.capture(sim);
+    auto start = std::chrono::steady_clock::now();
+    backend.drawFrame(snapshot, 1.0f);
+    addRenderTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+void StressTest::addRenderTime(double milliseconds) {
+    renderMeasured = true;
+    renderWindow.totalMs += milliseconds;
+    renderWindow.samples++;
+}
+
+void StressTest::closeWindow(Window& window, Capacity& capacity) {
+    if (window.samples > 0 && !window.overBudget) {
+        double average = window.totalMs / window.samples;
+        if (average <= config.budgetMs) {
+            capacity.measured = true;
+            capacity.enemies = sim.getEnemies().size();
+            capacity.bullets = sim.getBullets().size();
+            capacity.particles = sim.getParticles().size();
+            capacity.averageMs = average;
+        } else {
+            window.overBudget = true;
+        }
+    }
+    window.totalMs = 0;
+    window.samples = 0;
+}
+
+bool StressTest::finished() const {
+    if (ticks >= config.maxTicks) return true;
+    return simulationWindow.overBudget && (!renderMeasured || renderWindow.overBudget);
+}
+
+void StressTest::report(std::ostream& out) const {
+    auto line = [&out](const char* label, const Capacity& capacity, bool overBudget) {
+        out << label;
+        if (!capacity.measured) {
+            out << "over budget from the first window" << std::endl;
+            return;
+        }
+        out << capacity.total() << " entities (" << capacity.enemies << " enemies, " << capacity.bullets
+            << " bullets, " << capacity.particles << " particles) at " << capacity.averageMs << " ms";
+        if (!overBudget) out << ", budget never exceeded";
+        out << std::endl;
+    };
+
+    out << "Stress test: " << config.columns << "x" << config.rows << " grid, budget " << config.budgetMs
+        << " ms, " << ticks << " ticks" << std::endl;
+    line("  Simulation sustained: ", simulationCapacity, simulationWindow.overBudget);
+    if (renderMeasured) line("  Rendering sustained:  ", renderCapacity, renderWindow.overBudget);
+    if (sim.getParticles().size() == sim.getParticles().capacity()) {
+        out << "  Particle pool full (" << sim.getParticles().capacity() << "), further particles were dropped" << std::endl;
+    }
+}
@@ -0,0 +1,200 @@
+#include "../include/TerminalGame.h"
+#include <csignal>
+#include <iostream>
+#ifdef _WIN32
+#include <conio.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Frames change only with ticks and actions, so waiting for input doubles
+// as the frame pacing; a tick is drawn at most this late
+const int INPUT_WAIT_MS = 10;
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void onInterrupt(int) {
+    interrupted = 1;
+}
+
+// Unbuffered, unechoed keyboard input for the lifetime of the object
+class RawTerminal {
+public:
+    RawTerminal() = default;
+    RawTerminal(const RawTerminal&) = delete;
+    RawTerminal& operator=(const RawTerminal&) = delete;
+
+#ifdef _WIN32
+    bool enter() {
+        if (!_isatty(0) || !_isatty(1)) return false;
+        // Escape sequences are only interpreted when asked for
+        HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        return GetConsoleMode(output, &mode) &&
+               SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+
+    // Waits up to timeoutMs (-1: until a key or Ctrl-C) for keys and reads
+    // those waiting, with arrow keys translated to the escape sequences
+    // terminals send
+    int read(char* buffer, int capacity, int timeoutMs) {
+        for (int waited = 0; !_kbhit() && !interrupted && (timeoutMs < 0 || waited < timeoutMs); waited++) Sleep(1);
+        int count = 0;
+        while (count + 3 <= capacity && _kbhit()) {
+            int key = _getch();
+            if (key == 0 || key == 0xe0) {
+                int code = _getch();
+                if (code != 75 && code != 77) continue;
+                buffer[count++] = '\x1b';
+                buffer[count++] = '[';
+                buffer[count++] = code == 75 ? 'D' : 'C';
+            } else {
+                buffer[count++] = static_cast<char>(key);
+            }
+        }
+        return count;
+    }
+#else
+    ~RawTerminal() {
+        if (active) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+
+    bool enter() {
+        if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO) || tcgetattr(STDIN_FILENO, &saved) != 0) return false;
+        // Signals stay on, so Ctrl-C still interrupts
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return false;
+        active = true;
+        return true;
+    }
+
+    // Waits up to timeoutMs (-1: until a key or a signal) for keys and reads
+    // those waiting; -1 once the terminal has gone away
+    int read(char* buffer, int capacity, int timeoutMs) {
+        pollfd entry = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&entry, 1, timeoutMs) <= 0) return 0;
+        if (entry.revents & (POLLHUP | POLLERR)) return -1;
+        ssize_t count = ::read(STDIN_FILENO, buffer, capacity);
+        return count > 0 ? static_cast<int>(count) : 0;
+    }
+
+private:
+    termios saved = {};
+    bool active = false;
+#endif
+};
+
+}
+
+TerminalGame::TerminalGame(int width, int height, uint64_t seed, JobSystem* jobs)
+    : sim(width, height, seed), simThread(sim, recorder),
+      renderer(width / Simulation::TILE_SIZE, height / Simulation::TILE_SIZE, 1) {
+    sim.setJobSystem(jobs);
+}
+
+TerminalGame::~TerminalGame() {
+    simThread.stop();
+    recorder.close(sim);
+}
+
+bool TerminalGame::startRecording(const std::string& path) {
+    return recorder.open(path, sim);
+}
+
+bool TerminalGame::run() {
+    RawTerminal terminal;
+    if (!terminal.enter()) {
+        std::cerr << "Terminal mode needs stdin and stdout to be a terminal" << std::endl;
+        return false;
+    }
+    interrupted = 0;
+    auto previousInterrupt = std::signal(SIGINT, onInterrupt);
+    auto previousTerminate = std::signal(SIGTERM, onInterrupt);
+
+    simThread.start();
+    bool shown = false;
+    bool settled = false;
+    int64_t shownUpdate = 0;
+    uint32_t shownActions = 0;
+    char keys[64];
+    bool playing = true;
+    while (playing && !interrupted) {
+        // A settled simulation changes only with input, so there is nothing
+        // to wait for but keys
+        int count = terminal.read(keys, sizeof(keys), settled ? -1 : INPUT_WAIT_MS);
+        if (count < 0) break;
+        playing = handleKeys(keys, count);
+
+        // Includes this round's keys, as in the windowed game's low-latency mode
+        const SimSnapshot& snapshot = simThread.latest(actionsPushed, std::chrono::milliseconds(2));
+        if (!shown || snapshot.updateTime != shownUpdate || snapshot.actionsApplied != shownActions) {
+            renderer.drawFrame(snapshot, 1.0f);
+            shown = true;
+            shownUpdate = snapshot.updateTime;
+            shownActions = snapshot.actionsApplied;
+        }
+        settled = snapshot.settled;
+    }
+    simThread.stop();
+    renderer.restoreScreen();
+
+    std::signal(SIGINT, previousInterrupt);
+    std::signal(SIGTERM, previousTerminate);
+    return true;
+}
+
+bool TerminalGame::handleKeys(const char* keys, int count) {
+    for (int i = 0; i < count; i++) {
+        switch (keys[i]) {
+            case 'a':
+            case 'A':
+                applyAction(Simulation::Action::MOVE_LEFT);
+                break;
+            case 'd':
+            case 'D':
+                applyAction(Simulation::Action::MOVE_RIGHT);
+                break;
+            case ' ':
+                applyAction(Simulation::Action::FIRE);
+                break;
+            case '\r':
+            case '\n':
+                applyAction(Simulation::Action::CONFIRM);
+                break;
+            case 'p':
+            case 'P':
+                applyAction(Simulation::Action::PAUSE);
+                break;
+            case 'q':
+            case 'Q':
+                return false;
+            case '\x1b':
+                // Arrow keys arrive as ESC [ C / ESC [ D (or ESC O ...); ESC
+                // on its own pauses
+                if (i + 2 < count && (keys[i + 1] == '[' || keys[i + 1] == 'O')) {
+                    if (keys[i + 2] == 'D') applyAction(Simulation::Action::MOVE_LEFT);
+                    if (keys[i + 2] == 'C') applyAction(Simulation::Action::MOVE_RIGHT);
+                    i += 2;
+                } else {
+                    applyAction(Simulation::Action::PAUSE);
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+void TerminalGame::applyAction(Simulation::Action action) {
+    if (simThread.pushAction(action)) {
+        actionsPushed++;
+    }
+}
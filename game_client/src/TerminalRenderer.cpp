@@ -0,0 +1,261 @@
+#include "../include/TerminalRenderer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Select graphic rendition for each colour; bright variants read better on
+// both dark and light backgrounds
+const char* const SGR[] = {
+    "\x1b[0m",
+    "\x1b[91m",
+    "\x1b[92m",
+    "\x1b[93m",
+    "\x1b[94m",
+    "\x1b[96m",
+    "\x1b[97m",
+};
+
+// Alternate screen and hidden cursor while running; restored on exit
+const char ENTER_SCREEN[] = "\x1b[?1049h\x1b[?25l";
+const char LEAVE_SCREEN[] = "\x1b[0m\x1b[?25h\x1b[?1049l";
+const char CLEAR_SCREEN[] = "\x1b[0m\x1b[2J";
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned>(size));
+#else
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) continue;
+#endif
+        if (written <= 0) return false;
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Cheapest way to put the cursor at row, column from where it is; row and
+// column are zero-based, fromRow -1 means unknown
+size_t formatMove(int fromRow, int fromColumn, int row, int column, char* buffer, size_t capacity) {
+    if (fromRow == row && fromColumn >= 0 && column > fromColumn) {
+        int distance = column - fromColumn;
+        return distance == 1 ? std::snprintf(buffer, capacity, "\x1b[C")
+                             : std::snprintf(buffer, capacity, "\x1b[%dC", distance);
+    }
+    if (fromRow == row && column == 0) return std::snprintf(buffer, capacity, "\r");
+    if (fromRow >= 0 && row == fromRow + 1 && column == 0) return std::snprintf(buffer, capacity, "\r\n");
+    return std::snprintf(buffer, capacity, "\x1b[%d;%dH", row + 1, column + 1);
+}
+
+}
+
+TerminalRenderer::TerminalRenderer(int columns, int rows, int fd)
+    : columns(columns), rows(rows), width(columns * 2 + 2), height(rows + 4), fd(fd),
+      back(static_cast<size_t>(width) * height), front(static_cast<size_t>(width) * height) {
+    // A full frame is the worst case: a colour change and a move per cell
+    out.reserve(back.size() * 16);
+}
+
+TerminalRenderer::~TerminalRenderer() {
+    restoreScreen();
+}
+
+void TerminalRenderer::restoreScreen() {
+    if (started && fd >= 0) writeAll(fd, LEAVE_SCREEN, sizeof(LEAVE_SCREEN) - 1);
+    started = false;
+    fullRedraw = true;
+}
+
+void TerminalRenderer::drawFrame(const SimSnapshot& snapshot, float) {
+    compose(snapshot);
+    emitChanges();
+    flush();
+}
+
+void TerminalRenderer::put(int row, int column, char ch, Color color) {
+    if (row < 0 || row >= height || column < 0 || column >= width) return;
+    // Blanks look the same in any colour, so they never need a colour change
+    back[static_cast<size_t>(row) * width + column] = {ch, ch == ' ' ? DEFAULT : color};
+}
+
+void TerminalRenderer::putText(int row, int column, const char* text, Color color) {
+    for (; *text; text++, column++) put(row, column, *text, color);
+}
+
+void TerminalRenderer::putCentered(int row, const char* text, Color color) {
+    putText(row, (width - static_cast<int>(std::strlen(text))) / 2, text, color);
+}
+
+void TerminalRenderer::putTile(int x, int y, const char* glyph, Color color) {
+    if (x < 0 || x >= columns || y < 0 || y >= rows) return;
+    put(y + 2, 1 + x * 2, glyph[0], color);
+    put(y + 2, 2 + x * 2, glyph[1], color);
+}
+
+void TerminalRenderer::compose(const SimSnapshot& snapshot) {
+    std::fill(back.begin(), back.end(), Cell{' ', DEFAULT});
+    char line[64];
+
+    // Title and score above the field
+    putText(0, 0, "STAR DEFENDER", CYAN);
+    std::snprintf(line, sizeof(line), "Score: %d", snapshot.score);
+    putText(0, width - static_cast<int>(std::strlen(line)), line, WHITE);
+
+    // Border around the field
+    for (int column = 1; column < width - 1; column++) {
+        put(1, column, '-', BLUE);
+        put(height - 2, column, '-', BLUE);
+    }
+    for (int row = 2; row < height - 2; row++) {
+        put(row, 0, '|', BLUE);
+        put(row, width - 1, '|', BLUE);
+    }
+    for (int row : {1, height - 2}) {
+        put(row, 0, '+', BLUE);
+        put(row, width - 1, '+', BLUE);
+    }
+
+    int middle = 2 + rows / 2;
+    const char* prompt = "A/D move  SPACE shoot  P pause  Q quit";
+    if (snapshot.state == Simulation::MENU) {
+        putCentered(middle - 1, "STAR DEFENDER", CYAN);
+        putCentered(middle + 1, "Press SPACE or ENTER to start", WHITE);
+        putText(height - 1, 0, prompt, DEFAULT);
+        return;
+    }
+
+    // Particles at half-tile resolution under everything else
+    const SimSnapshot::Particles& particles = snapshot.particles;
+    for (size_t i = 0; i < particles.size(); i++) {
+        int row = static_cast<int>(particles.y[i]) / Simulation::TILE_SIZE;
+        int column = static_cast<int>(particles.x[i] * 2) / Simulation::TILE_SIZE;
+        if (particles.x[i] < 0 || particles.y[i] < 0 || row >= rows || column >= columns * 2) continue;
+        put(row + 2, column + 1, '.', YELLOW);
+    }
+    for (size_t i = 0; i < snapshot.bullets.size(); i++) {
+        putTile(snapshot.bullets.x[i], snapshot.bullets.y[i], "||", YELLOW);
+    }
+    for (size_t i = 0; i < snapshot.enemies.size(); i++) {
+        putTile(snapshot.enemies.x[i], snapshot.enemies.y[i], "<>", RED);
+    }
+    for (size_t i = 0; i < snapshot.others.size(); i++) {
+        putTile(snapshot.others.x[i], snapshot.others.y[i], "/\\", CYAN);
+    }
+    putTile(snapshot.playerX, snapshot.playerY, "/\\", GREEN);
+
+    if (snapshot.state == Simulation::PAUSED) {
+        putCentered(middle, " PAUSED ", WHITE);
+        prompt = "Press P or ESC to resume  Q quit";
+    } else if (snapshot.state == Simulation::GAME_OVER) {
+        putCentered(middle - 1, " GAME OVER ", RED);
+        std::snprintf(line, sizeof(line), " Final score: %d ", snapshot.score);
+        putCentered(middle + 1, line, WHITE);
+        prompt = "Press SPACE to return to the menu  Q quit";
+    }
+    putText(height - 1, 0, prompt, DEFAULT);
+}
+
+size_t TerminalRenderer::moveCost(int row, int column) const {
+    char sequence[24];
+    return formatMove(cursorRow, cursorColumn, row, column, sequence, sizeof(sequence));
+}
+
+size_t TerminalRenderer::colorCost(Color color, int from) const {
+    return color == from ? 0 : std::strlen(SGR[color]);
+}
+
+void TerminalRenderer::moveTo(int row, int column) {
+    char sequence[24];
+    out.append(sequence, formatMove(cursorRow, cursorColumn, row, column, sequence, sizeof(sequence)));
+    cursorRow = row;
+    cursorColumn = column;
+}
+
+void TerminalRenderer::setColor(Color color) {
+    if (color == currentColor) return;
+    out += SGR[color];
+    currentColor = color;
+}
+
+void TerminalRenderer::emitChanges() {
+    out.clear();
+    if (!started) {
+        out += ENTER_SCREEN;
+        started = true;
+    }
+    if (fullRedraw) {
+        // A cleared screen is all default spaces, so only the rest is sent
+        out += CLEAR_SCREEN;
+        std::fill(front.begin(), front.end(), Cell{' ', DEFAULT});
+        currentColor = DEFAULT;
+        cursorRow = -1;
+        cursorColumn = -1;
+        fullRedraw = false;
+    }
+
+    auto writeCell = [this](size_t index) {
+        if (back[index].ch != ' ') setColor(back[index].color);
+        out += back[index].ch;
+        front[index] = back[index];
+        // Past the last column the cursor waits to wrap; where it ends up
+        // differs between terminals
+        if (++cursorColumn >= width) cursorRow = -1;
+    };
+
+    for (int row = 0; row < height; row++) {
+        size_t rowStart = static_cast<size_t>(row) * width;
+        for (int column = 0; column < width; column++) {
+            size_t index = rowStart + column;
+            if (back[index] == front[index]) continue;
+            counters.cellsChanged++;
+
+            if (cursorRow == row && cursorColumn == column) {
+                writeCell(index);
+                continue;
+            }
+            if (cursorRow == row && cursorColumn >= 0 && cursorColumn < column) {
+                // Rewriting a short gap of unchanged cells can beat moving over it
+                size_t rewrite = 0;
+                int color = currentColor;
+                for (int c = cursorColumn; c < column; c++) {
+                    const Cell& cell = back[rowStart + c];
+                    if (cell.ch == ' ') {
+                        rewrite++;
+                        continue;
+                    }
+                    rewrite += 1 + colorCost(cell.color, color);
+                    color = cell.color;
+                }
+                if (rewrite <= moveCost(row, column)) {
+                    while (cursorColumn < column) writeCell(rowStart + cursorColumn);
+                    writeCell(index);
+                    continue;
+                }
+            }
+            moveTo(row, column);
+            writeCell(index);
+        }
+    }
+}
+
+void TerminalRenderer::flush() {
+    if (fd >= 0 && !out.empty()) writeAll(fd, out.data(), out.size());
+    uint64_t bytes = out.size();
+    if (counters.frames == 0) {
+        counters.firstFrameBytes = bytes;
+    } else {
+        counters.maxFrameBytes = std::max(counters.maxFrameBytes, bytes);
+    }
+    counters.frames++;
+    counters.bytes += bytes;
+    counters.lastFrameBytes = bytes;
+}
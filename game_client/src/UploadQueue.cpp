@@ -0,0 +1,223 @@
+#include "../include/UploadQueue.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#ifdef STAR_DEFENDER_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename T>
+void appendBytes(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+// gzip rather than raw deflate, so the server can decode it as a standard
+// Content-Encoding; false leaves the body to go uncompressed
+bool gzip(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+#ifdef STAR_DEFENDER_ZLIB
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    out.resize(deflateBound(&stream, static_cast<uLong>(in.size())));
+    stream.next_in = const_cast<Bytef*>(in.data());
+    stream.avail_in = static_cast<uInt>(in.size());
+    stream.next_out = out.data();
+    stream.avail_out = static_cast<uInt>(out.size());
+    bool done = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return done;
+#else
+    (void)in;
+    (void)out;
+    return false;
+#endif
+}
+
+}
+
+UploadQueue::UploadQueue(const UploadConfig& config) : config(config) {}
+
+UploadQueue::~UploadQueue() {
+    stop();
+}
+
+bool UploadQueue::start() {
+    if (running.load()) return true;
+    if (!url.parse(config.url)) {
+        std::cerr << "Invalid upload URL " << config.url << " (expected http://host[:port]/path)" << std::endl;
+        return false;
+    }
+    if (!log.open(config.logPath, pending)) return false;
+    pendingCount = pending.size();
+    if (!pending.empty()) {
+        std::cout << pending.size() << " uploads pending from a previous run" << std::endl;
+    }
+
+    running = true;
+    worker = std::thread([this] { loop(); });
+    return true;
+}
+
+void UploadQueue::stop() {
+    if (!running.exchange(false)) return;
+    wake.release();
+    worker.join();
+    log.close();
+}
+
+bool UploadQueue::submit(Record&& record) {
+    if (!queue.push(std::move(record))) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    submitted.fetch_add(1, std::memory_order_relaxed);
+    // Only the first record since the worker last woke needs to signal it
+    if (!wakePending.exchange(true, std::memory_order_acq_rel)) {
+        wake.release();
+    }
+    return true;
+}
+
+bool UploadQueue::submitScore(const upload::ScoreRecord& score) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&score);
+    return submit({upload::RECORD_SCORE, std::vector<uint8_t>(bytes, bytes + sizeof(score))});
+}
+
+bool UploadQueue::submitSnapshot(std::vector<uint8_t>&& snapshot) {
+    return submit({upload::RECORD_SNAPSHOT, std::move(snapshot)});
+}
+
+UploadQueue::Stats UploadQueue::stats() const {
+    return {submitted.load(), dropped.load(), uploaded.load(), rejected.load(), failedAttempts.load(),
+            pendingCount.load()};
+}
+
+void UploadQueue::drainQueue() {
+    Record record;
+    bool appended = false;
+    while (queue.pop(record)) {
+        uint64_t sequence = log.append(record.type, record.payload.data(), record.payload.size());
+        if (sequence == 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        pending.push_back({sequence, record.type, std::move(record.payload)});
+        appended = true;
+    }
+    // One flush for everything that arrived together
+    if (appended && !log.sync()) {
+        std::cerr << "Error syncing upload log" << std::endl;
+    }
+    pendingCount = pending.size();
+}
+
+bool UploadQueue::sendBatch() {
+    PROFILE_ZONE("uploadBatch");
+    size_t count = 0;
+    size_t bytes = 0;
+    while (count < pending.size() && count < config.maxBatchRecords &&
+           (count == 0 || bytes + pending[count].payload.size() <= config.maxBatchBytes)) {
+        bytes += pending[count].payload.size();
+        count++;
+    }
+
+    upload::BatchHeader header = {};
+    std::memcpy(header.magic, upload::MAGIC, 4);
+    header.version = upload::VERSION;
+    header.clientId = log.getClientId();
+    header.count = static_cast<uint32_t>(count);
+    body.clear();
+    appendBytes(body, header);
+    for (size_t i = 0; i < count; i++) {
+        const WriteAheadLog::Entry& entry = pending[i];
+        upload::BatchRecord record = {entry.type, entry.sequence, static_cast<uint32_t>(entry.payload.size())};
+        appendBytes(body, record);
+        body.insert(body.end(), entry.payload.begin(), entry.payload.end());
+    }
+
+    HttpHeaders headers = {{"Content-Type", "application/octet-stream"}};
+    const std::vector<uint8_t>* payload = &body;
+    if (gzip(body, compressed) && compressed.size() < body.size()) {
+        headers.push_back({"Content-Encoding", "gzip"});
+        payload = &compressed;
+    }
+
+    HttpResponse response = httpPost(url, headers, payload->data(), payload->size(), config.timeoutMs);
+    retryAfterMs = response.retryAfterSeconds >= 0 ? response.retryAfterSeconds * 1000 : -1;
+    bool accepted = response.status >= 200 && response.status < 300;
+    bool transient = response.status == 0 || response.status == 408 || response.status == 429 || response.status >= 500;
+    if (!accepted && transient) {
+        failedAttempts.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (accepted) {
+        uploaded.fetch_add(count, std::memory_order_relaxed);
+    } else {
+        // Resending a batch the server refuses as malformed would only block the ones behind it
+        std::cerr << "Upload rejected with HTTP " << response.status << ", discarding " << count << " records" << std::endl;
+        rejected.fetch_add(count, std::memory_order_relaxed);
+    }
+    uint64_t last = pending[count - 1].sequence;
+    pending.erase(pending.begin(), pending.begin() + count);
+    log.acknowledge(last, pending);
+    pendingCount = pending.size();
+    return true;
+}
+
+void UploadQueue::sleepFor(std::chrono::milliseconds duration) {
+    // Submissions and stop() cut the sleep short
+    (void)wake.try_acquire_for(duration);
+    wakePending.store(false, std::memory_order_release);
+}
+
+void UploadQueue::loop() {
+    std::minstd_rand jitter(std::random_device{}());
+    int failures = 0;
+    auto gatherUntil = Clock::now() + std::chrono::milliseconds(config.batchDelayMs);
+    auto retryAt = Clock::now();
+
+    while (running.load(std::memory_order_acquire)) {
+        bool wasEmpty = pending.empty();
+        drainQueue();
+        if (pending.empty()) {
+            wake.acquire();
+            wakePending.store(false, std::memory_order_release);
+            continue;
+        }
+        auto now = Clock::now();
+        if (wasEmpty) gatherUntil = now + std::chrono::milliseconds(config.batchDelayMs);
+
+        // Send once the batch is full or has gathered long enough, never
+        // before a backoff ends
+        auto sendAt = std::max(pending.size() >= config.maxBatchRecords ? now : gatherUntil, retryAt);
+        if (now < sendAt) {
+            sleepFor(std::chrono::duration_cast<std::chrono::milliseconds>(sendAt - now) + std::chrono::milliseconds(1));
+            continue;
+        }
+
+        if (sendBatch()) {
+            failures = 0;
+            retryAt = Clock::now();
+        } else {
+            // Exponential backoff with jitter, so many clients recovering
+            // from the same outage do not retry in lockstep
+            int backoff = config.initialBackoffMs << std::min(failures, 16);
+            backoff = std::min(backoff, config.maxBackoffMs);
+            int delay = backoff / 2 + static_cast<int>(jitter() % (backoff / 2 + 1));
+            if (retryAfterMs >= 0) delay = std::min(std::max(delay, retryAfterMs), config.maxBackoffMs);
+            retryAt = Clock::now() + std::chrono::milliseconds(delay);
+            failures++;
+        }
+    }
+
+    // Everything submitted before stop() reaches the log
+    drainQueue();
+}
@@ -0,0 +1,251 @@
+#include "../include/WriteAheadLog.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace wal {
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc) {
+    static const auto table = [] {
+        std::array<uint32_t, 256> entries;
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+            }
+            entries[i] = value;
+        }
+        return entries;
+    }();
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+}
+
+namespace {
+
+// Covers the length and everything after the checksum field
+uint32_t entryChecksum(const wal::EntryHeader& header, const uint8_t* payload) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&header);
+    const size_t tail = offsetof(wal::EntryHeader, sequence);
+    uint32_t crc = wal::crc32(&header.length, sizeof(header.length));
+    crc = wal::crc32(bytes + tail, sizeof(header) - tail, crc);
+    return wal::crc32(payload, header.length, crc);
+}
+
+bool flushToDisk(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open(const std::string& logPath, std::vector<Entry>& pending) {
+    close();
+    path = logPath;
+    pending.clear();
+
+    std::vector<uint8_t> contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (in) contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // Walk the entries up to the first one that is short or fails its checksum
+    uint64_t acknowledged = 0;
+    uint64_t lastSequence = 0;
+    clientId = 0;
+    size_t offset = 0;
+    std::vector<Entry> entries;
+    while (contents.size() - offset >= sizeof(wal::EntryHeader)) {
+        wal::EntryHeader header;
+        std::memcpy(&header, contents.data() + offset, sizeof(header));
+        if (header.length > contents.size() - offset - sizeof(header)) break;
+        const uint8_t* payload = contents.data() + offset + sizeof(header);
+        if (entryChecksum(header, payload) != header.checksum) break;
+
+        if (header.type == wal::TYPE_CLIENT && header.length == sizeof(clientId)) {
+            std::memcpy(&clientId, payload, sizeof(clientId));
+        } else if (header.type == wal::TYPE_ACK) {
+            acknowledged = std::max(acknowledged, header.sequence);
+        } else {
+            entries.push_back({header.sequence, header.type, {payload, payload + header.length}});
+        }
+        lastSequence = std::max(lastSequence, header.sequence);
+        offset += sizeof(header) + header.length;
+    }
+
+    if (offset < contents.size()) {
+        std::cerr << "Discarding " << contents.size() - offset << " damaged bytes at the end of " << path << std::endl;
+        std::error_code error;
+        std::filesystem::resize_file(path, offset, error);
+        if (error) {
+            std::cerr << "Error truncating " << path << ": " << error.message() << std::endl;
+            return false;
+        }
+    }
+
+    file = std::fopen(path.c_str(), "ab");
+    if (!file) {
+        std::cerr << "Error opening " << path << std::endl;
+        return false;
+    }
+    size = offset;
+    syncedSize = offset;
+    recordsLost = false;
+    nextSequence = lastSequence + 1;
+
+    for (auto& entry : entries) {
+        if (entry.sequence > acknowledged) pending.push_back(std::move(entry));
+    }
+
+    if (clientId == 0) {
+        std::random_device device;
+        clientId = (uint64_t(device()) << 32) | device();
+        if (!writeEntry(file, 0, wal::TYPE_CLIENT, reinterpret_cast<const uint8_t*>(&clientId), sizeof(clientId)) ||
+            !sync()) {
+            std::cerr << "Error writing " << path << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void WriteAheadLog::close() {
+    if (file) {
+        flushToDisk(file);
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+bool WriteAheadLog::writeEntry(std::FILE* out, uint64_t sequence, uint8_t type, const uint8_t* data, size_t length) {
+    wal::EntryHeader header = {};
+    header.length = static_cast<uint32_t>(length);
+    header.sequence = sequence;
+    header.type = type;
+    header.checksum = entryChecksum(header, data);
+    if (std::fwrite(&header, sizeof(header), 1, out) != 1) return false;
+    if (length && std::fwrite(data, length, 1, out) != 1) return false;
+    if (out == file) size += sizeof(header) + length;
+    return true;
+}
+
+uint64_t WriteAheadLog::append(uint8_t type, const uint8_t* data, size_t length) {
+    if (!file) return 0;
+    uint64_t sequence = nextSequence;
+    if (!writeEntry(file, sequence, type, data, length)) {
+        std::cerr << "Error appending to " << path << std::endl;
+        rollback();
+        return 0;
+    }
+    nextSequence++;
+    return sequence;
+}
+
+bool WriteAheadLog::sync() {
+    if (!file) return false;
+    if (!flushToDisk(file)) {
+        std::cerr << "Error syncing " << path << std::endl;
+        rollback();
+    }
+    // Records cut off by a rollback since the last sync were never durable
+    bool ok = file && !recordsLost;
+    recordsLost = false;
+    if (ok) syncedSize = size;
+    return ok;
+}
+
+void WriteAheadLog::rollback() {
+    // Part of an entry may have reached the file, and later entries written
+    // after it would be cut off with it on the next open. Everything since
+    // the last sync goes, as the stdio buffer may have been partly written.
+    std::fclose(file);
+    file = nullptr;
+    std::error_code error;
+    std::filesystem::resize_file(path, syncedSize, error);
+    if (!error) file = std::fopen(path.c_str(), "ab");
+    if (!file) {
+        std::cerr << "Error restoring " << path << "; no more records will be logged" << std::endl;
+        return;
+    }
+    size = syncedSize;
+    recordsLost = true;
+}
+
+bool WriteAheadLog::acknowledge(uint64_t sequence, const std::vector<Entry>& pending) {
+    bool written = file && writeEntry(file, sequence, wal::TYPE_ACK, nullptr, 0);
+    if (file && !written) rollback();
+    if (!written || !sync()) {
+        std::cerr << "Error acknowledging uploads in " << path << std::endl;
+        return false;
+    }
+    uint64_t pendingBytes = 0;
+    for (const Entry& entry : pending) {
+        pendingBytes += sizeof(wal::EntryHeader) + entry.payload.size();
+    }
+    if (size > COMPACT_SIZE && pendingBytes < size / 2) {
+        return compact(sequence, pending);
+    }
+    return true;
+}
+
+bool WriteAheadLog::compact(uint64_t acknowledged, const std::vector<Entry>& pending) {
+    // Written beside the log and renamed over it, so a crash leaves one whole copy
+    std::string tempPath = path + ".tmp";
+    std::FILE* out = std::fopen(tempPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Error creating " << tempPath << std::endl;
+        return false;
+    }
+    bool ok = writeEntry(out, 0, wal::TYPE_CLIENT, reinterpret_cast<const uint8_t*>(&clientId), sizeof(clientId)) &&
+              writeEntry(out, acknowledged, wal::TYPE_ACK, nullptr, 0);
+    uint64_t written = 2 * sizeof(wal::EntryHeader) + sizeof(clientId);
+    for (const Entry& entry : pending) {
+        ok = ok && writeEntry(out, entry.sequence, entry.type, entry.payload.data(), entry.payload.size());
+        written += sizeof(wal::EntryHeader) + entry.payload.size();
+    }
+    ok = flushToDisk(out) && ok;
+    std::fclose(out);
+
+    std::error_code error;
+    if (ok) {
+        std::fclose(file);
+        std::filesystem::rename(tempPath, path, error);
+        file = std::fopen(path.c_str(), "ab");
+    }
+    if (!ok || error || !file) {
+        std::cerr << "Error compacting " << path << std::endl;
+        std::filesystem::remove(tempPath, error);
+        if (!file) file = std::fopen(path.c_str(), "ab");
+        return false;
+    }
+    size = written;
+    syncedSize = written;
+    return true;
+}
@@ -1,21 +1,272 @@
+#include "../include/Autopilot.h"
 #include "../include/Game.h"
+#include "../include/InputRecording.h"
+#include "../include/NetSession.h"
+#include "../include/Profiler.h"
+#include "../include/Simulation.h"
+#include "../include/StressTest.h"
+#include "../include/TerminalGame.h"
+#include "../include/UploadQueue.h"
 #include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
 
 void cleanup(SDL_Window *win) {
     SDL_DestroyWindow(win);
     SDL_Quit();
 }
 
+// Steps the simulation as fast as possible without SDL video, driven by the
+// autopilot; finished games are restarted immediately.
+int runHeadless(int width, int height, long ticks, uint64_t seed, JobSystem* jobs) {
+    Simulation sim(width, height, seed);
+    sim.setJobSystem(jobs);
+    sim.applyAction(Simulation::Action::CONFIRM);
+
+    long games = 1;
+    long long totalScore = 0;
+
+    std::cout << "Seed: " << seed << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < ticks; i++) {
+        if (sim.getGameState() == Simulation::GAME_OVER) {
+            totalScore += sim.getScore();
+            sim.applyAction(Simulation::Action::CONFIRM); // back to menu
+            sim.applyAction(Simulation::Action::CONFIRM); // new game
+            games++;
+        }
+        driveAutopilot(sim);
+        sim.update();
+        profiler::endFrame();
+    }
+    auto end = std::chrono::steady_clock::now();
+    totalScore += sim.getScore();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Headless run: " << ticks << " ticks in " << seconds << " s ("
+              << (seconds > 0 ? ticks / seconds : 0) << " ticks/s)" << std::endl;
+    std::cout << "Games played: " << games << ", total score: " << totalScore << std::endl;
+    return 0;
+}
+
+// Replays a recorded session unthrottled, checking its state hashes
+int runReplay(const std::string& path, JobSystem* jobs) {
+    InputReplay replay;
+    if (!replay.open(path)) return 1;
+    Simulation sim(replay.getWidth(), replay.getHeight(), replay.getSeed());
+    sim.setJobSystem(jobs);
+
+    auto start = std::chrono::steady_clock::now();
+    InputReplay::Result result = replay.run(sim);
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Replay: " << result.updates << " updates, " << result.actions << " actions in " << seconds
+              << " s (" << (seconds > 0 ? result.updates / seconds : 0) << " updates/s)" << std::endl;
+    if (result.mismatchAt >= 0) {
+        std::cerr << "Replay diverged: state hash mismatch after update " << result.mismatchAt << std::endl;
+        return 1;
+    }
+    std::cout << result.hashesChecked << " state hashes matched";
+    if (!result.complete) std::cout << " (recording ends without an end marker)";
+    std::cout << std::endl;
+    return 0;
+}
+
+// Ramps load on a headless simulation until ticks exceed the budget
+int runStress(const StressConfig& config, JobSystem* jobs) {
+    StressTest stress(config);
+    stress.getSimulation().setJobSystem(jobs);
+    while (!stress.finished()) {
+        stress.tick();
+    }
+    stress.report(std::cout);
+    return 0;
+}
+
+void printLoopStats(const Game::LoopStats& stats) {
+    if (stats.seconds <= 0) return;
+    std::printf("Main loop: %.0f wakeups/s, %.1f frames/s, %.1f%% of a core\n", stats.wakeups / stats.seconds,
+                stats.frames / stats.seconds, 100 * stats.cpuSeconds / stats.seconds);
+    if (stats.idleSeconds > 0) {
+        std::printf("Idle screens: %.1f s, %.1f wakeups/s, %.2f s of CPU per idle minute\n", stats.idleSeconds,
+                    stats.idleWakeups / stats.idleSeconds, 60 * stats.idleCpuSeconds / stats.idleSeconds);
+    }
+}
+
+void printTerminalStats(const TerminalRenderer::Stats& stats) {
+    std::cout << "Terminal output: " << stats.frames << " frames, "
+              << (stats.frames ? stats.bytes / stats.frames : 0) << " bytes per frame on average (max "
+              << stats.maxFrameBytes << "), first frame " << stats.firstFrameBytes << " bytes" << std::endl;
+}
+
+// Plays in the terminal without SDL, or with a stress config renders the
+// stress test there instead
+int runTerminal(int width, int height, uint64_t seed, const char* recordPath, const StressConfig* stressConfig,
+                JobSystem* jobs) {
+    TerminalRenderer::Stats stats;
+    if (stressConfig) {
+        StressTest stress(*stressConfig);
+        stress.getSimulation().setJobSystem(jobs);
+        {
+            TerminalRenderer renderer(stressConfig->columns, stressConfig->rows, 1);
+            while (!stress.finished()) {
+                stress.tick();
+                stress.render(renderer);
+            }
+            stats = renderer.stats();
+        }
+        stress.report(std::cout);
+    } else {
+        TerminalGame game(width, height, seed, jobs);
+        if (recordPath && !game.startRecording(recordPath)) return 1;
+        if (!game.run()) return 1;
+        stats = game.outputStats();
+    }
+    printTerminalStats(stats);
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
+    int width = 800;
+    int height = 600;
+
+    bool headless = false;
+    long ticks = 100000;
+    uint64_t seed = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* syncUrl = nullptr;
+    bool host = false;
+    const char* joinAddress = nullptr;
+    uint16_t port = net::DEFAULT_PORT;
+    LinkConditions linkConditions;
+    unsigned threads = 1;
+    bool trackLatency = false;
+    bool lowLatency = false;
+    double moveRate = Simulation::TICKS_PER_SECOND;
+    bool idleWait = true;
+    bool terminal = false;
+    bool stress = false;
+    bool stressRender = false;
+    bool stressGrid = false;
+    StressConfig stressConfig;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--sync") == 0 && i + 1 < argc) {
+            syncUrl = argv[++i];
+        } else if (std::strcmp(argv[i], "--host") == 0) {
+            host = true;
+        } else if (std::strcmp(argv[i], "--join") == 0 && i + 1 < argc) {
+            joinAddress = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+            linkConditions.lossPercent = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--net-delay") == 0 && i + 1 < argc) {
+            linkConditions.delayMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--net-jitter") == 0 && i + 1 < argc) {
+            linkConditions.jitterMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            profiler::startTrace(argv[++i]);
+        } else if (std::strcmp(argv[i], "--latency") == 0) {
+            trackLatency = true;
+        } else if (std::strcmp(argv[i], "--low-latency") == 0) {
+            lowLatency = true;
+        } else if (std::strcmp(argv[i], "--move-rate") == 0 && i + 1 < argc) {
+            moveRate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-idle") == 0) {
+            idleWait = false;
+        } else if (std::strcmp(argv[i], "--terminal") == 0) {
+            terminal = true;
+        } else if (std::strcmp(argv[i], "--stress") == 0) {
+            stress = true;
+        } else if (std::strcmp(argv[i], "--stress-render") == 0) {
+            stressRender = true;
+        } else if (std::strcmp(argv[i], "--spawn-rate") == 0 && i + 1 < argc) {
+            stressConfig.spawnRate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--fire-rate") == 0 && i + 1 < argc) {
+            stressConfig.fireRate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--particles") == 0 && i + 1 < argc) {
+            stressConfig.particleMultiplier = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            stressConfig.budgetMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--grid") == 0 && i + 1 < argc &&
+                   std::sscanf(argv[i + 1], "%dx%d", &stressConfig.columns, &stressConfig.rows) == 2) {
+            stressGrid = true;
+            i++;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--headless [--ticks N]] [--replay file] [--threads N]"
+                      << " [--record file] [--seed N] [--trace out.json] [--sync http://host:port/path]" << std::endl;
+            std::cerr << "       " << argv[0] << " [--latency] [--low-latency [--move-rate N]] [--no-idle]" << std::endl;
+            std::cerr << "       " << argv[0] << " --terminal [--stress-render [--grid CxR]]" << std::endl;
+            std::cerr << "       " << argv[0] << " --stress | --stress-render [--spawn-rate R] [--fire-rate R]"
+                      << " [--grid CxR] [--particles M] [--budget MS]" << std::endl;
+            std::cerr << "       " << argv[0] << " --host [--port N] | --join host[:port]"
+                      << " [--net-loss PCT] [--net-delay MS] [--net-jitter MS]" << std::endl;
+            return 1;
+        }
+    }
+    if ((host || joinAddress) && recordPath) {
+        // Recordings hold one player's actions, so a co-op game would not replay
+        std::cerr << "--record cannot be combined with --host or --join" << std::endl;
+        return 1;
+    }
+    stressConfig.seed = seed;
+
+    if (replayPath || headless || stress) {
+        // Serial unless asked otherwise; the windowed game sizes its own
+        std::unique_ptr<JobSystem> jobs;
+        if (threads != 1) jobs = std::make_unique<JobSystem>(threads);
+        int result = replayPath ? runReplay(replayPath, jobs.get())
+                   : stress     ? runStress(stressConfig, jobs.get())
+                                : runHeadless(width, height, ticks, seed, jobs.get());
+        profiler::writeTrace();
+        return result;
+    }
+
+    if (stressRender) {
+        // Frame times must reflect drawing cost, not the display's refresh rate
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+        if (!stressGrid) {
+            stressConfig.columns = width / Simulation::TILE_SIZE;
+            stressConfig.rows = height / Simulation::TILE_SIZE;
+        }
+    }
+
+    if (terminal) {
+        if (host || joinAddress || syncUrl) {
+            std::cerr << "--terminal cannot be combined with --host, --join or --sync" << std::endl;
+            return 1;
+        }
+        std::unique_ptr<JobSystem> jobs;
+        if (threads != 1) jobs = std::make_unique<JobSystem>(threads);
+        int result = runTerminal(width, height, seed, recordPath, stressRender ? &stressConfig : nullptr, jobs.get());
+        profiler::writeTrace();
+        return result;
+    }
+
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "ERROR", "Error initializing SDL3", nullptr);
         return 1;
     };
 
-    int width = 800;
-    int height = 600;
-
     SDL_Window *win = SDL_CreateWindow("Star Defender", width, height, 0);
     if (!win) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "ERROR", "Error creating window", win);
@@ -23,10 +274,105 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // Results queued for upload persist in the user's data directory
+    std::unique_ptr<UploadQueue> uploads;
+    if (syncUrl) {
+        UploadConfig config;
+        config.url = syncUrl;
+        char* prefPath = SDL_GetPrefPath("sdradic", "star_defender");
+        config.logPath = std::string(prefPath ? prefPath : "") + "uploads.wal";
+        SDL_free(prefPath);
+        uploads = std::make_unique<UploadQueue>(config);
+        if (!uploads->start()) {
+            cleanup(win);
+            return 1;
+        }
+    }
+
+    // Co-op: the host runs the game as usual and serves its state; a client
+    // joins before its window opens a game
+    std::unique_ptr<NetHost> netHost;
+    std::unique_ptr<NetClient> netClient;
+    uint64_t linkSeed = seed ^ 0x6e6574ull;
+    if (host) {
+        netHost = std::make_unique<NetHost>();
+        netHost->setConditions(linkConditions, linkSeed);
+        if (!netHost->open(port)) {
+            cleanup(win);
+            return 1;
+        }
+    } else if (joinAddress) {
+        std::string address = joinAddress;
+        size_t colon = address.rfind(':');
+        if (colon != std::string::npos) {
+            port = static_cast<uint16_t>(std::atoi(address.c_str() + colon + 1));
+            address.resize(colon);
+        }
+        NetAddress hostAddress;
+        netClient = std::make_unique<NetClient>(width, height);
+        netClient->setConditions(linkConditions, linkSeed);
+        if (!hostAddress.resolve(address, port)) {
+            std::cerr << "Cannot resolve " << address << std::endl;
+            cleanup(win);
+            return 1;
+        }
+        if (!netClient->connect(hostAddress, 5000)) {
+            cleanup(win);
+            return 1;
+        }
+    }
+
     // Create and run the game
-    Game game(win, width, height);
-    game.run();
+    {
+        std::cout << "Seed: " << seed << std::endl;
+        Game game(win, width, height, seed);
+        if (recordPath && !game.startRecording(recordPath)) {
+            cleanup(win);
+            return 1;
+        }
+        if (uploads) game.enableUploads(*uploads);
+        if (netHost) game.enableHosting(*netHost);
+        if (trackLatency) game.enableLatencyTracking();
+        if (lowLatency) game.enableLowLatencyInput(moveRate);
+        if (!idleWait) game.disableIdleWait();
+        if (stressRender) {
+            StressTest stressTest(stressConfig);
+            game.runStress(stressTest);
+            stressTest.report(std::cout);
+        } else if (netClient) {
+            game.runClient(*netClient);
+        } else {
+            game.run();
+            printLoopStats(game.getLoopStats());
+        }
+        
+        if (trackLatency) {
+            LatencyTracker::Summary summary = game.getLatency();
+            std::printf("Input to present (%s input): %zu inputs, p50 %.1f p95 %.1f p99 %.1f max %.1f ms\n",
+                        lowLatency ? "low-latency" : "event", summary.inputs, summary.p50, summary.p95, summary.p99,
+                        summary.max);
+        }
+    }
 
+    if (uploads) {
+        uploads->stop();
+        UploadQueue::Stats stats = uploads->stats();
+        std::cout << "Uploads: " << stats.uploaded << " sent, " << stats.pending << " pending" << std::endl;
+    }
+
+    if (netHost) {
+        NetHost::Stats stats = netHost->stats();
+        std::cout << "Hosted " << stats.frames << " ticks, "
+                  << (stats.framesSent ? stats.bytesSent / stats.framesSent : 0) << " bytes per client per tick" << std::endl;
+    }
+    if (netClient) {
+        const NetClient::Stats& stats = netClient->stats();
+        std::cout << "Received " << stats.frames << " frames, " << stats.framesSkipped << " skipped, "
+                  << stats.corrections << " prediction corrections" << std::endl;
+    }
+
+    // Written after the game is gone so loader threads have flushed their zones
+    profiler::writeTrace();
     cleanup(win);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,169 @@
+#include "../include/AssetPack.h"
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// Build-time tool: decodes the sprite PNGs into one RGBA32 atlas and writes
+// it, the sprite regions and the raw font files into a single pack file.
+//
+//     star_defender_pack <assets directory> <output pack>
+
+namespace {
+
+struct Sprite {
+    std::string name;
+    std::string file;
+    SDL_Surface* surface = nullptr;
+    int x = 0, y = 0;
+};
+
+struct Blob {
+    pack::PackEntry entry;
+    std::vector<uint8_t> bytes;
+};
+
+const int ATLAS_WIDTH = 512;
+const int PADDING = 1;
+
+pack::PackEntry makeEntry(const std::string& name, uint32_t type) {
+    pack::PackEntry entry = {};
+    std::strncpy(entry.name, name.c_str(), pack::NAME_LENGTH - 1);
+    entry.type = type;
+    return entry;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <assets directory> <output pack>" << std::endl;
+        return 1;
+    }
+    std::string assets = std::string(argv[1]) + "/";
+
+    std::vector<Sprite> sprites = {
+        {"player", "player_128.png"},
+        {"enemy", "enemy_128.png"},
+        {"bullet", "bullet_128.png"},
+        {"background", "background.png"},
+    };
+    const char* fonts[] = {"Pixel Game.otf", "Pixel Game Extrude.otf"};
+
+    // Decode every sprite to RGBA32
+    for (auto& sprite : sprites) {
+        SDL_Surface* loaded = IMG_Load((assets + sprite.file).c_str());
+        if (!loaded) {
+            std::cerr << "Error loading image " << sprite.file << ": " << SDL_GetError() << std::endl;
+            return 1;
+        }
+        sprite.surface = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32);
+        SDL_DestroySurface(loaded);
+        if (!sprite.surface) {
+            std::cerr << "Error converting image " << sprite.file << ": " << SDL_GetError() << std::endl;
+            return 1;
+        }
+    }
+
+    for (const auto& sprite : sprites) {
+        if (sprite.surface->w > ATLAS_WIDTH) {
+            std::cerr << "Error: " << sprite.file << " is " << sprite.surface->w
+                      << " pixels wide, wider than the " << ATLAS_WIDTH << " pixel atlas" << std::endl;
+            return 1;
+        }
+    }
+
+    // Shelf-pack the sprites, tallest first
+    std::vector<Sprite*> order;
+    for (auto& sprite : sprites) order.push_back(&sprite);
+    std::sort(order.begin(), order.end(), [](const Sprite* a, const Sprite* b) {
+        return a->surface->h > b->surface->h;
+    });
+    int penX = 0, penY = 0, rowHeight = 0;
+    for (Sprite* sprite : order) {
+        if (penX + sprite->surface->w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + PADDING;
+            rowHeight = 0;
+        }
+        sprite->x = penX;
+        sprite->y = penY;
+        penX += sprite->surface->w + PADDING;
+        rowHeight = std::max(rowHeight, sprite->surface->h);
+    }
+    int atlasHeight = penY + rowHeight;
+
+    std::vector<Blob> blobs;
+    Blob atlas = {makeEntry("atlas", pack::IMAGE), std::vector<uint8_t>(static_cast<size_t>(ATLAS_WIDTH) * atlasHeight * 4, 0)};
+    atlas.entry.width = ATLAS_WIDTH;
+    atlas.entry.height = atlasHeight;
+    for (auto& sprite : sprites) {
+        SDL_Surface* surface = sprite.surface;
+        for (int row = 0; row < surface->h; row++) {
+            const uint8_t* src = static_cast<const uint8_t*>(surface->pixels) + row * surface->pitch;
+            uint8_t* dst = atlas.bytes.data() + ((sprite.y + row) * ATLAS_WIDTH + sprite.x) * 4;
+            std::memcpy(dst, src, surface->w * 4);
+        }
+    }
+    blobs.push_back(std::move(atlas));
+
+    for (auto& sprite : sprites) {
+        Blob region = {makeEntry(sprite.name, pack::REGION), {}};
+        region.entry.parent = 0;
+        region.entry.x = sprite.x;
+        region.entry.y = sprite.y;
+        region.entry.width = sprite.surface->w;
+        region.entry.height = sprite.surface->h;
+        blobs.push_back(std::move(region));
+        SDL_DestroySurface(sprite.surface);
+    }
+
+    for (const char* font : fonts) {
+        std::ifstream in(assets + font, std::ios::binary);
+        if (!in) {
+            std::cerr << "Error loading font " << font << std::endl;
+            return 1;
+        }
+        Blob blob = {makeEntry(std::string("font:") + font, pack::FONT),
+                     std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>())};
+        blobs.push_back(std::move(blob));
+    }
+
+    // Assign aligned offsets after the header and directory
+    uint64_t offset = sizeof(pack::PackHeader) + blobs.size() * sizeof(pack::PackEntry);
+    for (auto& blob : blobs) {
+        if (blob.bytes.empty()) continue;
+        offset = (offset + pack::PACK_ALIGNMENT - 1) / pack::PACK_ALIGNMENT * pack::PACK_ALIGNMENT;
+        blob.entry.offset = offset;
+        blob.entry.size = blob.bytes.size();
+        offset += blob.bytes.size();
+    }
+
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    pack::PackHeader header = {};
+    std::memcpy(header.magic, pack::MAGIC, 4);
+    header.version = pack::VERSION;
+    header.entryCount = static_cast<uint32_t>(blobs.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& blob : blobs) {
+        out.write(reinterpret_cast<const char*>(&blob.entry), sizeof(blob.entry));
+    }
+    for (const auto& blob : blobs) {
+        if (blob.bytes.empty()) continue;
+        std::vector<char> pad(blob.entry.offset - static_cast<uint64_t>(out.tellp()), 0);
+        out.write(pad.data(), pad.size());
+        out.write(reinterpret_cast<const char*>(blob.bytes.data()), blob.bytes.size());
+    }
+    if (!out) {
+        std::cerr << "Error writing " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << blobs.size() << " entries (" << ATLAS_WIDTH << "x" << atlasHeight
+              << " atlas) into " << argv[2] << std::endl;
+    return 0;
+}
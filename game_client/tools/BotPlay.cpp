@@ -0,0 +1,74 @@
+#include "../include/Autopilot.h"
+#include "../include/BotPlay.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Plays thousands of autopilot sessions across every core without rendering
+// and reports score, length, peak entity and tick cost distributions. With
+// --scaling the same sessions are played with 1 to N threads, reporting
+// throughput and checking that every run's outcomes match.
+//
+//     star_defender_botplay [--sessions N] [--policy name] [--seed N] [--threads N]
+//                           [--grid CxR] [--max-ticks N] [--scaling]
+
+int main(int argc, char *argv[]) {
+    BotPlayConfig config;
+    bool scaling = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+            config.sessions = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            config.policy = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            config.maxTicks = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--grid") == 0 && i + 1 < argc &&
+                   std::sscanf(argv[i + 1], "%dx%d", &config.columns, &config.rows) == 2) {
+            i++;
+        } else if (std::strcmp(argv[i], "--scaling") == 0) {
+            scaling = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--sessions N] [--policy name] [--seed N] [--threads N]"
+                      << " [--grid CxR] [--max-ticks N] [--scaling]" << std::endl;
+            std::cerr << "Policies: " << autopilotPolicyNames() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!scaling) {
+        BotPlay play(config);
+        if (!play.run()) return 1;
+        play.report(std::cout);
+        return 0;
+    }
+
+    // Doubling thread counts up to the requested or hardware count
+    unsigned maxThreads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%d sessions of %s, 1 to %u threads\n", config.sessions, config.policy.c_str(), maxThreads);
+    std::printf("threads\tsessions/s\tspeedup\toutcomes\n");
+    double serial = 0;
+    uint64_t expected = 0;
+    bool allMatch = true;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        config.threads = threads;
+        BotPlay play(config);
+        if (!play.run()) return 1;
+        if (threads == 1) {
+            serial = play.sessionsPerSecond();
+            expected = play.resultHash();
+        }
+        bool match = play.resultHash() == expected;
+        allMatch &= match;
+        std::printf("%u\t%.1f\t\t%.2f\t%s\n", threads, play.sessionsPerSecond(),
+                    serial > 0 ? play.sessionsPerSecond() / serial : 0.0, match ? "match" : "MISMATCH");
+        if (threads == maxThreads) break;
+    }
+    return allMatch ? 0 : 1;
+}
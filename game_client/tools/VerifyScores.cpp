@@ -0,0 +1,113 @@
+#include "../include/ReplayVerifier.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Verifies submitted scores against their recordings, for the backend to run
+// as a long-lived child process. Claims arrive on stdin one per line:
+//
+//     <seed> <claimed score> <recording path>
+//
+// A blank line or the end of input closes a batch, which is verified across
+// every core; a line per claim then follows on stdout, in order, and a blank
+// line ends the batch:
+//
+//     <verdict> <replayed score> <updates>
+//
+// Verdicts are those of ReplayVerifier, plus "unreadable" for a recording
+// that cannot be read and "invalid" for a line that does not parse.
+//
+//     star_defender_verify [--threads N] [--field WxH] [--max-updates N]
+
+namespace {
+
+struct Line {
+    bool valid = false;
+    bool readable = false;
+};
+
+// Reads one claim line into claim; the path is the rest of the line
+Line parseClaim(const std::string& text, VerifyClaim& claim) {
+    Line line;
+    std::istringstream in(text);
+    std::string path;
+    if (!(in >> claim.seed >> claim.score) || !std::getline(in >> std::ws, path) || path.empty()) return line;
+    line.valid = true;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return line;
+    claim.log.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    line.readable = true;
+    return line;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    VerifyConfig config;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--field") == 0 && i + 1 < argc &&
+                   std::sscanf(argv[i + 1], "%dx%d", &config.width, &config.height) == 2) {
+            i++;
+        } else if (std::strcmp(argv[i], "--max-updates") == 0 && i + 1 < argc) {
+            config.maxUpdates = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--threads N] [--field WxH] [--max-updates N] < claims" << std::endl;
+            return 1;
+        }
+    }
+
+    ReplayVerifier verifier(config);
+    std::vector<VerifyClaim> claims;
+    std::vector<Line> lines;
+    std::vector<ReplayVerifier::Result> results;
+    uint64_t verified = 0;
+    double busySeconds = 0;
+
+    std::string text;
+    bool more = true;
+    while (more) {
+        more = static_cast<bool>(std::getline(std::cin, text));
+        if (more && !text.empty()) {
+            VerifyClaim claim = {};
+            lines.push_back(parseClaim(text, claim));
+            claims.push_back(std::move(claim));
+            continue;
+        }
+        if (lines.empty()) continue;
+
+        // Claims that could not be read go through as empty logs and are
+        // reported by what went wrong instead
+        auto start = std::chrono::steady_clock::now();
+        verifier.verify(claims, results);
+        busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        verified += claims.size();
+
+        for (size_t i = 0; i < lines.size(); i++) {
+            const char* verdict = !lines[i].valid    ? "invalid"
+                                : !lines[i].readable ? "unreadable"
+                                                     : ReplayVerifier::verdictName(results[i].verdict);
+            std::printf("%s %d %llu\n", verdict, results[i].score, static_cast<unsigned long long>(results[i].updates));
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+        claims.clear();
+        lines.clear();
+    }
+
+    if (verified > 0 && busySeconds > 0) {
+        std::fprintf(stderr, "Verified %llu claims in %.3f s: %.0f per second, %.0f per thread\n",
+                     static_cast<unsigned long long>(verified), busySeconds, verified / busySeconds,
+                     verified / busySeconds / verifier.getThreads());
+    }
+    return 0;
+}